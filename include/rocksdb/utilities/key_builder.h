@@ -0,0 +1,106 @@
+#pragma once
+
+#include <rocksdb/write_batch.h>
+
+#include <string>
+#include <tuple>
+
+#include "rocksdb/utilities/serialize.h"
+
+// Encodes one row at a time into buffers that are reused across rows, and
+// adds it to a WriteBatch without building an intermediate key string:
+//
+//   KeyBuilder row;
+//   row.SetKeyPrefix(std::make_tuple(schema_id));
+//   for (...) {
+//     row.Reset();
+//     row.KeyColumns(std::forward_as_tuple(album, photo));
+//     row.ValueColumns(std::make_tuple(size));
+//     row.PutTo(&batch);
+//   }
+//
+// Leading key columns shared by many rows can be encoded once with
+// SetKeyPrefix(); the key is then handed to the batch as SliceParts.
+class KeyBuilder {
+ public:
+  KeyBuilder() {}
+
+  // Encode the leading key columns of the following rows. The prefix is
+  // kept across Reset().
+  template<typename... Ts>
+  void SetKeyPrefix(const std::tuple<Ts...>& prefix) {
+    prefix_.clear();
+    SerializeTuple(prefix, prefix_);
+  }
+
+  void ClearKeyPrefix() { prefix_.clear(); }
+
+  // Start a new row. Memory allocated for earlier rows is kept.
+  void Reset() {
+    key_.clear();
+    value_.clear();
+  }
+
+  // Append one column to the key or the value.
+  template<typename T>
+  KeyBuilder& Key(const T& val) {
+    Serialize<T>(val, key_);
+    return *this;
+  }
+
+  template<typename T>
+  KeyBuilder& DescendingKey(const T& val) {
+    SerializeDescending<T>(val, key_);
+    return *this;
+  }
+
+  template<typename T>
+  KeyBuilder& Value(const T& val) {
+    Serialize<T>(val, value_);
+    return *this;
+  }
+
+  // Append several columns at once, see SerializeTuple.
+  template<typename... Ts>
+  KeyBuilder& KeyColumns(const std::tuple<Ts...>& vals) {
+    SerializeTuple(vals, key_);
+    return *this;
+  }
+
+  template<typename... Ts>
+  KeyBuilder& ValueColumns(const std::tuple<Ts...>& vals) {
+    SerializeTuple(vals, value_);
+    return *this;
+  }
+
+  // The buffers of the current row, for callers that encode columns
+  // themselves. The key buffer excludes the prefix.
+  std::string* mutable_key() { return &key_; }
+  std::string* mutable_value() { return &value_; }
+
+  // The encoded key, including the prefix. The parts point into the
+  // builder and are valid until the next call that modifies it.
+  rocksdb::SliceParts key() {
+    key_parts_[0] = rocksdb::Slice(prefix_);
+    key_parts_[1] = rocksdb::Slice(key_);
+    return rocksdb::SliceParts(key_parts_, 2);
+  }
+
+  rocksdb::Slice value() const { return rocksdb::Slice(value_); }
+
+  // Size of the encoded key, including the prefix.
+  size_t key_size() const { return prefix_.size() + key_.size(); }
+
+  // Add the current row to batch. This is the only copy of the encoded
+  // bytes: WriteBatch appends the parts to its own buffer.
+  void PutTo(rocksdb::WriteBatch* batch) {
+    rocksdb::Slice value_slice = value();
+    batch->Put(key(), rocksdb::SliceParts(&value_slice, 1));
+  }
+
+ private:
+  std::string prefix_;
+  std::string key_;
+  std::string value_;
+  rocksdb::Slice key_parts_[2];
+};
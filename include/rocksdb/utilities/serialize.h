@@ -1,49 +1,118 @@
 #pragma once
 
 #include <rocksdb/slice.h>
+#include <assert.h>
 #include <endian.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 // Serialize type T into a byte comprable
 // string and append to out.
 template<typename T>
-void Serialize(T val, std::string& out);
+void Serialize(const T& val, std::string& out);
 
 template<typename T>
 T Deserialize(rocksdb::Slice& in);
 
 // Specializations
 template<>
-inline void Serialize(int64_t val, std::string& out) {
-  val ^= (1UL << 63);
-  val = htobe64(val);
-  out.append((const char *) &val, sizeof(val));
+inline void Serialize(const int64_t& val, std::string& out) {
+  int64_t tmp = val ^ (1UL << 63);
+  tmp = htobe64(tmp);
+  out.append((const char *) &tmp, sizeof(tmp));
 }
 
 template<>
-inline void Serialize(bool val, std::string& out) {
+inline void Serialize(const bool& val, std::string& out) {
   out.append((const char *) &val, sizeof(val));
 }
 
+// -0.0 is written as 0.0: with its sign bit it would sort below every
+// negative number. Floats are the same.
 template<>
-inline void Serialize(double val, std::string& out) {
+inline void Serialize(const double& val, std::string& out) {
+  const double v = val == 0 ? 0.0 : val;
   int64_t mask = -1;
-  if (val >= 0) {
+  if (v >= 0) {
     mask = 1UL << 63;
   }
   int64_t buf;
-  buf = *(int64_t *) &val;
+  memcpy(&buf, &v, sizeof(buf));
   buf ^= mask;
   buf = htobe64(buf);
   out.append((const char *) &buf, sizeof(buf));
 }
 
+// Strings are written as their bytes followed by a two byte terminator.
+// Embedded NULs are escaped so that they can't be confused with the
+// terminator and still sort before every other byte:
+//
+//   \0 => \0 \xFF
+//   end => \0 \x01
+//
+// A string therefore sorts before all of its extensions, and no encoded
+// string is a prefix of another.
+const char kStringEscape = '\0';
+const char kStringEscapedNul = '\xFF';
+const char kStringTerminator = '\x01';
+
+namespace serialize_internal {
+
+// Find the terminator of the encoded string starting at p, given the
+// escape byte and the byte that follows it for an escaped NUL. Returns
+// end if the string isn't terminated.
+inline const char* FindStringEnd(const char* p, const char* end,
+                                 char escape, char escaped_nul) {
+  while ((p = (const char *) memchr(p, escape, end - p)) &&
+         p + 1 < end && p[1] == escaped_nul) {
+    p += 2;
+  }
+  if (p == nullptr || p + 1 >= end) {
+    return end;
+  }
+  return p;
+}
+
+inline void SerializeString(const char* data, size_t n, std::string& out) {
+  out.reserve(out.size() + n + 2);
+  // memchr is vectorized by the C library, so strings without NULs cost
+  // about as much as a memcpy.
+  const char* end = data + n;
+  const char* p;
+  while ((p = (const char *) memchr(data, kStringEscape, end - data))) {
+    out.append(data, p - data + 1);
+    out.push_back(kStringEscapedNul);
+    data = p + 1;
+  }
+  out.append(data, end - data);
+  out.push_back(kStringEscape);
+  out.push_back(kStringTerminator);
+}
+
+}  // namespace serialize_internal
+
+template<>
+inline void Serialize(const std::string& val, std::string& out) {
+  serialize_internal::SerializeString(val.data(), val.size(), out);
+}
+
+template<>
+inline void Serialize(const rocksdb::Slice& val, std::string& out) {
+  serialize_internal::SerializeString(val.data(), val.size(), out);
+}
+
+#if __cplusplus >= 201703L
 template<>
-inline void Serialize(std::string val, std::string& out) {
-  // +1 to include the null terminated char
-  out.append((const char *) val.c_str(), val.length() + 1);
+inline void Serialize(const std::string_view& val, std::string& out) {
+  serialize_internal::SerializeString(val.data(), val.size(), out);
 }
+#endif
 
 template<>
 inline int64_t Deserialize(rocksdb::Slice& in) {
@@ -67,7 +136,10 @@ inline double Deserialize(rocksdb::Slice& in) {
   int64_t mask = -1;
   tmp = be64toh(tmp);
   auto *tmpd = (double *) &tmp;
-  if (*tmpd < 0) {
+  // The sign bit is set for encoded non-negative values. Test it as an
+  // integer so that the encoding of 0.0 (only the sign bit set) decodes
+  // to 0.0 rather than NaN.
+  if (tmp < 0) {
     mask = 1UL << 63;
   }
   tmp ^= mask;
@@ -75,15 +147,812 @@ inline double Deserialize(rocksdb::Slice& in) {
   return *tmpd;
 }
 
+// Narrower ints, unsigned ints and floats use the same encodings as
+// int64_t and double at their own width: big endian, with the sign bit
+// flipped for signed ints, and every bit flipped for negative floats.
+// Unsigned ints are plain big endian.
+namespace serialize_internal {
+
+template<typename U>
+inline void AppendBigEndian(U v, std::string& out) {
+  char buf[sizeof(U)];
+  for (size_t i = 0; i < sizeof(U); i++) {
+    buf[i] = (char) (v >> (8 * (sizeof(U) - 1 - i)));
+  }
+  out.append(buf, sizeof(buf));
+}
+
+template<typename U>
+inline U ReadBigEndian(rocksdb::Slice& in) {
+  U v = 0;
+  for (size_t i = 0; i < sizeof(U); i++) {
+    v = (U) ((v << 8) | (uint8_t) in[i]);
+  }
+  in.remove_prefix(sizeof(U));
+  return v;
+}
+
+template<typename T, typename U>
+inline void SerializeSigned(T val, std::string& out) {
+  AppendBigEndian<U>((U) val ^ ((U) 1 << (8 * sizeof(U) - 1)), out);
+}
+
+template<typename T, typename U>
+inline T DeserializeSigned(rocksdb::Slice& in) {
+  return (T) (ReadBigEndian<U>(in) ^ ((U) 1 << (8 * sizeof(U) - 1)));
+}
+
+}  // namespace serialize_internal
+
+template<>
+inline void Serialize(const int8_t& val, std::string& out) {
+  serialize_internal::SerializeSigned<int8_t, uint8_t>(val, out);
+}
+
+template<>
+inline void Serialize(const int16_t& val, std::string& out) {
+  serialize_internal::SerializeSigned<int16_t, uint16_t>(val, out);
+}
+
+template<>
+inline void Serialize(const int32_t& val, std::string& out) {
+  serialize_internal::SerializeSigned<int32_t, uint32_t>(val, out);
+}
+
+template<>
+inline void Serialize(const uint8_t& val, std::string& out) {
+  serialize_internal::AppendBigEndian<uint8_t>(val, out);
+}
+
+template<>
+inline void Serialize(const uint16_t& val, std::string& out) {
+  serialize_internal::AppendBigEndian<uint16_t>(val, out);
+}
+
+template<>
+inline void Serialize(const uint32_t& val, std::string& out) {
+  serialize_internal::AppendBigEndian<uint32_t>(val, out);
+}
+
+template<>
+inline void Serialize(const uint64_t& val, std::string& out) {
+  serialize_internal::AppendBigEndian<uint64_t>(val, out);
+}
+
+template<>
+inline void Serialize(const float& val, std::string& out) {
+  const float v = val == 0 ? 0.0f : val;
+  uint32_t mask = ~0U;
+  if (v >= 0) {
+    mask = 1U << 31;
+  }
+  uint32_t buf;
+  memcpy(&buf, &v, sizeof(buf));
+  serialize_internal::AppendBigEndian<uint32_t>(buf ^ mask, out);
+}
+
+template<>
+inline int8_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::DeserializeSigned<int8_t, uint8_t>(in);
+}
+
+template<>
+inline int16_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::DeserializeSigned<int16_t, uint16_t>(in);
+}
+
+template<>
+inline int32_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::DeserializeSigned<int32_t, uint32_t>(in);
+}
+
+template<>
+inline uint8_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::ReadBigEndian<uint8_t>(in);
+}
+
+template<>
+inline uint16_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::ReadBigEndian<uint16_t>(in);
+}
+
+template<>
+inline uint32_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::ReadBigEndian<uint32_t>(in);
+}
+
+template<>
+inline uint64_t Deserialize(rocksdb::Slice& in) {
+  return serialize_internal::ReadBigEndian<uint64_t>(in);
+}
+
+template<>
+inline float Deserialize(rocksdb::Slice& in) {
+  uint32_t buf = serialize_internal::ReadBigEndian<uint32_t>(in);
+  // As for doubles, the sign bit is set for encoded non-negative values.
+  uint32_t mask = (buf >> 31) ? 1U << 31 : ~0U;
+  buf ^= mask;
+  float val;
+  memcpy(&val, &buf, sizeof(val));
+  return val;
+}
+
+// A time in microseconds since the epoch. It is encoded like an int64_t;
+// the type only marks the column as a time, e.g. for a ttl_column.
+struct Timestamp {
+  Timestamp(int64_t us = 0) : micros(us) {}
+  operator int64_t() const { return micros; }
+
+  int64_t micros;
+};
+
+template<>
+inline void Serialize(const Timestamp& val, std::string& out) {
+  Serialize<int64_t>(val.micros, out);
+}
+
+template<>
+inline Timestamp Deserialize(rocksdb::Slice& in) {
+  return Timestamp(Deserialize<int64_t>(in));
+}
+
+// Decode a string and consume it from in. The result points into in
+// unless the string contains escaped NULs, in which case it is unescaped
+// into *scratch and the result points there.
+inline rocksdb::Slice DeserializeString(rocksdb::Slice& in,
+                                        std::string* scratch) {
+  const char* start = in.data();
+  const char* end = start + in.size();
+  const char* p = start;
+  bool escaped = false;
+  while ((p = (const char *) memchr(p, kStringEscape, end - p)) &&
+         p + 1 < end && p[1] == kStringEscapedNul) {
+    if (!escaped) {
+      scratch->clear();
+      escaped = true;
+    }
+    scratch->append(start, p - start + 1);
+    p += 2;
+    start = p;
+  }
+  if (p == nullptr || p + 1 >= end) {
+    // Missing terminator, consume everything that is left.
+    p = end;
+  }
+  rocksdb::Slice result(start, p - start);
+  in.remove_prefix(p == end ? in.size() : p + 2 - in.data());
+  if (!escaped) {
+    return result;
+  }
+  scratch->append(result.data(), result.size());
+  return rocksdb::Slice(*scratch);
+}
+
+// Returns a view into in. A string with embedded NULs can't be returned
+// without unescaping it, so Slice columns must not contain NULs; use
+// DeserializeString() or Deserialize<std::string> if the column may.
 template<>
 inline rocksdb::Slice Deserialize(rocksdb::Slice& in) {
-  size_t len = strnlen(in.data(), in.size());
-  rocksdb::Slice tmp(in.data(), len);
-  in.remove_prefix(len + 1);
+  const char* start = in.data();
+  const char* end = start + in.size();
+  const char* p = serialize_internal::FindStringEnd(start, end, kStringEscape,
+                                                    kStringEscapedNul);
+  // Any escape before the terminator is an escaped NUL.
+  assert(memchr(start, kStringEscape, p - start) == nullptr);
+  rocksdb::Slice tmp(start, p - start);
+  in.remove_prefix(p == end ? in.size() : p + 2 - start);
   return tmp;
 }
 
 template<>
 inline std::string Deserialize(rocksdb::Slice& in) {
-  return Deserialize<rocksdb::Slice>(in).ToString();
+  std::string scratch;
+  auto s = DeserializeString(in, &scratch);
+  if (s.data() == scratch.data()) {
+    return scratch;
+  }
+  return s.ToString();
+}
+
+// Fixed width strings, for char(N) columns: the bytes of the string
+// padded with NULs to width, so every value has the same encoded size.
+// A string sorts before its extensions, as with variable length strings,
+// but trailing NULs are lost, so "a" and "a\0" encode the same. Strings
+// longer than width are cut to it. Callers should reject both kinds
+// first.
+inline void SerializeFixedString(const rocksdb::Slice& val, size_t width,
+                                 std::string& out) {
+  size_t n = val.size() < width ? val.size() : width;
+  out.append(val.data(), n);
+  out.append(width - n, '\0');
+}
+
+// Decode a fixed width string and consume width bytes from in. The
+// result points into in.
+inline rocksdb::Slice DeserializeFixedString(rocksdb::Slice& in,
+                                             size_t width) {
+  const char* p = in.data();
+  size_t n = width;
+  while (n > 0 && p[n - 1] == '\0') {
+    n--;
+  }
+  in.remove_prefix(width);
+  return rocksdb::Slice(p, n);
+}
+
+// Batch variants of Serialize and Deserialize for contiguous columns of
+// fixed width values. The output is byte for byte the same as calling
+// Serialize<T> on each value in turn, but the work is done with SIMD
+// byte shuffles when the CPU supports them.
+void SerializeBatch(const int64_t* vals, size_t n, std::string& out);
+void SerializeBatch(const double* vals, size_t n, std::string& out);
+
+// Decode n values from in into vals and consume them from in.
+void DeserializeBatch(rocksdb::Slice& in, int64_t* vals, size_t n);
+void DeserializeBatch(rocksdb::Slice& in, double* vals, size_t n);
+
+// Encoded width of T. kFixed is true when every value of T serializes
+// to exactly kSize bytes, and false for variable length types.
+template<typename T>
+struct EncodedWidth {
+  static const bool kFixed = false;
+  static const size_t kSize = 0;
+};
+
+template<>
+struct EncodedWidth<int64_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(int64_t);
+};
+
+template<>
+struct EncodedWidth<bool> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(bool);
+};
+
+template<>
+struct EncodedWidth<double> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(double);
+};
+
+template<>
+struct EncodedWidth<int8_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(int8_t);
+};
+
+template<>
+struct EncodedWidth<int16_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(int16_t);
+};
+
+template<>
+struct EncodedWidth<int32_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(int32_t);
+};
+
+template<>
+struct EncodedWidth<uint8_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(uint8_t);
+};
+
+template<>
+struct EncodedWidth<uint16_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(uint16_t);
+};
+
+template<>
+struct EncodedWidth<uint32_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(uint32_t);
+};
+
+template<>
+struct EncodedWidth<uint64_t> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(uint64_t);
+};
+
+template<>
+struct EncodedWidth<float> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(float);
+};
+
+template<>
+struct EncodedWidth<Timestamp> {
+  static const bool kFixed = true;
+  static const size_t kSize = sizeof(int64_t);
+};
+
+// Number of bytes Serialize<T>(val, out) appends to out.
+template<typename T>
+inline size_t EncodedSize(const T& /* val */) {
+  static_assert(EncodedWidth<T>::kFixed,
+                "EncodedSize must be specialized for variable length types");
+  return EncodedWidth<T>::kSize;
+}
+
+// For strings this is a lower bound: every embedded NUL takes one more
+// byte.
+template<>
+inline size_t EncodedSize(const std::string& val) {
+  return val.size() + 2;
+}
+
+template<>
+inline size_t EncodedSize(const rocksdb::Slice& val) {
+  return val.size() + 2;
+}
+
+namespace serialize_internal {
+
+inline void InvertBytes(char* p, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    p[i] = ~p[i];
+  }
+}
+
+}  // namespace serialize_internal
+
+// Descending columns are encoded by inverting every byte of the
+// ascending encoding. The ascending encodings are prefix free, so this
+// exactly reverses their order, and one key can mix ascending and
+// descending columns under the default bytewise comparator.
+template<typename T>
+inline void SerializeDescending(const T& val, std::string& out) {
+  size_t start = out.size();
+  Serialize<T>(val, out);
+  serialize_internal::InvertBytes(&out[start], out.size() - start);
+}
+
+template<typename T>
+inline T DeserializeDescending(rocksdb::Slice& in) {
+  static_assert(EncodedWidth<T>::kFixed,
+                "DeserializeDescending must be specialized for variable "
+                "length types");
+  char buf[EncodedWidth<T>::kSize];
+  memcpy(buf, in.data(), sizeof(buf));
+  serialize_internal::InvertBytes(buf, sizeof(buf));
+  in.remove_prefix(sizeof(buf));
+  rocksdb::Slice tmp(buf, sizeof(buf));
+  return Deserialize<T>(tmp);
+}
+
+// A descending string can't be returned as a view of the input, so it is
+// always decoded into a new string.
+template<>
+inline std::string DeserializeDescending(rocksdb::Slice& in) {
+  const char escape = ~kStringEscape;
+  const char escaped_nul = ~kStringEscapedNul;
+  std::string result;
+  const char* p = in.data();
+  const char* end = p + in.size();
+  while (true) {
+    const char* q = (const char *) memchr(p, escape, end - p);
+    if (q == nullptr || q + 1 >= end) {
+      // Missing terminator, consume everything that is left.
+      q = end;
+    }
+    size_t start = result.size();
+    result.append(p, q - p);
+    serialize_internal::InvertBytes(&result[start], q - p);
+    if (q == end) {
+      p = end;
+      break;
+    }
+    p = q + 2;
+    if (q[1] != escaped_nul) {
+      break;
+    }
+    result.push_back('\0');
+  }
+  in.remove_prefix(p - in.data());
+  return result;
+}
+
+// Marks a column of SerializeTuple/DeserializeTuple as descending:
+//
+//   SerializeTuple(std::make_tuple(id, Desc(timestamp)), out);
+//   DeserializeTuple<int64_t, Descending<int64_t>>(in);
+//
+// The wrapper only holds a reference to the value, and decoding yields
+// a plain T.
+template<typename T>
+struct Descending {
+  const T& val;
+};
+
+template<typename T>
+inline Descending<T> Desc(const T& val) {
+  return Descending<T>{val};
+}
+
+template<typename T>
+struct EncodedWidth<Descending<T>> : EncodedWidth<T> {};
+
+// An int64_t in a compact, order preserving variable length encoding.
+// The first byte orders values by their length and holds small values:
+//
+//   0x00 - 0x07  negative, followed by 8 - b bytes of the value
+//   0x08 - 0xF7  0 to 239, stored in the byte itself
+//   0xF8 - 0xFF  240 and up, followed by b - 0xF7 bytes of the value
+//
+// The trailing bytes are the low bytes of the value, big endian. Values
+// from 0 to 239 take one byte and values up to 65535 take three.
+struct VarInt64 {
+  VarInt64(int64_t v = 0) : val(v) {}
+  operator int64_t() const { return val; }
+
+  int64_t val;
+};
+
+const uint8_t kVarIntNegativeBase = 0x08;
+const uint8_t kVarIntSmallMax = 0xF7 - kVarIntNegativeBase;
+
+// Length of the encoded VarInt64 whose first byte is b.
+inline size_t VarInt64Length(uint8_t b) {
+  if (b < kVarIntNegativeBase) {
+    return 1 + kVarIntNegativeBase - b;
+  }
+  if (b <= 0xF7) {
+    return 1;
+  }
+  return 1 + b - 0xF7;
+}
+
+namespace serialize_internal {
+
+// Number of bytes needed to hold the magnitude u, at least 1.
+inline size_t VarIntPayloadSize(uint64_t u) {
+  size_t n = 1;
+  while (n < sizeof(u) && (u >> (8 * n)) != 0) {
+    n++;
+  }
+  return n;
+}
+
+}  // namespace serialize_internal
+
+template<>
+inline size_t EncodedSize(const VarInt64& v) {
+  if (v.val >= 0 && v.val <= kVarIntSmallMax) {
+    return 1;
+  }
+  uint64_t u = v.val < 0 ? ~(uint64_t) v.val : (uint64_t) v.val;
+  return 1 + serialize_internal::VarIntPayloadSize(u);
+}
+
+template<>
+inline void Serialize(const VarInt64& v, std::string& out) {
+  if (v.val >= 0 && v.val <= kVarIntSmallMax) {
+    out.push_back((char) (kVarIntNegativeBase + v.val));
+    return;
+  }
+  size_t n = EncodedSize<VarInt64>(v) - 1;
+  uint8_t prefix = v.val < 0 ? kVarIntNegativeBase - n : 0xF7 + n;
+  uint64_t be = htobe64((uint64_t) v.val);
+  out.push_back((char) prefix);
+  out.append((const char *) &be + sizeof(be) - n, n);
+}
+
+template<>
+inline VarInt64 Deserialize(rocksdb::Slice& in) {
+  uint8_t b = in[0];
+  size_t len = VarInt64Length(b);
+  if (len == 1) {
+    in.remove_prefix(1);
+    return VarInt64(b - kVarIntNegativeBase);
+  }
+  size_t n = len - 1;
+  // Sign extend negative values.
+  uint64_t v = b < kVarIntNegativeBase ? ~0UL : 0;
+  for (size_t i = 1; i <= n; i++) {
+    v = (v << 8) | (uint8_t) in[i];
+  }
+  in.remove_prefix(len);
+  return VarInt64((int64_t) v);
+}
+
+template<>
+inline VarInt64 DeserializeDescending(rocksdb::Slice& in) {
+  char buf[1 + sizeof(int64_t)];
+  buf[0] = ~in[0];
+  size_t len = VarInt64Length(buf[0]);
+  memcpy(buf + 1, in.data() + 1, len - 1);
+  serialize_internal::InvertBytes(buf + 1, len - 1);
+  in.remove_prefix(len);
+  rocksdb::Slice tmp(buf, len);
+  return Deserialize<VarInt64>(tmp);
+}
+
+// Consume one encoded T from in without decoding it.
+template<typename T>
+inline void SkipEncoded(rocksdb::Slice& in) {
+  static_assert(EncodedWidth<T>::kFixed,
+                "SkipEncoded must be specialized for variable length types");
+  in.remove_prefix(EncodedWidth<T>::kSize);
+}
+
+namespace serialize_internal {
+
+inline void SkipString(rocksdb::Slice& in, char escape, char escaped_nul) {
+  const char* end = in.data() + in.size();
+  const char* p = FindStringEnd(in.data(), end, escape, escaped_nul);
+  in.remove_prefix(p == end ? in.size() : p + 2 - in.data());
+}
+
+}  // namespace serialize_internal
+
+template<>
+inline void SkipEncoded<std::string>(rocksdb::Slice& in) {
+  serialize_internal::SkipString(in, kStringEscape, kStringEscapedNul);
+}
+
+template<>
+inline void SkipEncoded<rocksdb::Slice>(rocksdb::Slice& in) {
+  serialize_internal::SkipString(in, kStringEscape, kStringEscapedNul);
+}
+
+template<>
+inline void SkipEncoded<VarInt64>(rocksdb::Slice& in) {
+  in.remove_prefix(VarInt64Length(in[0]));
+}
+
+// Same as SkipEncoded, for a column written with SerializeDescending.
+template<typename T>
+inline void SkipEncodedDescending(rocksdb::Slice& in) {
+  SkipEncoded<T>(in);
+}
+
+template<>
+inline void SkipEncodedDescending<std::string>(rocksdb::Slice& in) {
+  serialize_internal::SkipString(in, ~kStringEscape, ~kStringEscapedNul);
+}
+
+template<>
+inline void SkipEncodedDescending<rocksdb::Slice>(rocksdb::Slice& in) {
+  serialize_internal::SkipString(in, ~kStringEscape, ~kStringEscapedNul);
+}
+
+template<>
+inline void SkipEncodedDescending<VarInt64>(rocksdb::Slice& in) {
+  in.remove_prefix(VarInt64Length(~in[0]));
+}
+
+// The code of a string in an order preserving dictionary, such as
+// rocksdb::table::StringDictionary. The dictionary assigns codes in the
+// order of its strings, so comparing encoded codes compares the strings,
+// and a low cardinality column takes a byte or two instead of the string
+// and its terminator.
+//
+// A code is the number n + 0.d1 d2 ... in base 128: an int and fraction
+// digits from 0 to 127, the last of which isn't 0. The dictionary hands
+// out ints with small gaps and only takes digits once a gap has run out,
+// so most codes are just an int. The encoding is the VarInt64 2n + 1
+// if there are digits and 2n otherwise, followed by one byte per digit,
+// d << 1 with the low bit set on all but the last. A code with digits
+// takes the int and then one byte for each digit, and sorts before every
+// code with a longer fraction starting with its own.
+struct DictCode {
+  DictCode(int64_t i = 0) : n(i) {}
+
+  int64_t n;
+  std::string digits;
+};
+
+inline bool operator==(const DictCode& a, const DictCode& b) {
+  return a.n == b.n && a.digits == b.digits;
+}
+
+inline bool operator!=(const DictCode& a, const DictCode& b) {
+  return !(a == b);
+}
+
+inline bool operator<(const DictCode& a, const DictCode& b) {
+  return a.n != b.n ? a.n < b.n : a.digits < b.digits;
+}
+
+// The largest int of a DictCode, so that 2n + 1 fits in an int64_t.
+const int64_t kDictCodeMax = INT64_MAX / 2;
+
+// Length of the encoded DictCode at the start of in, or 0 if in ends
+// before it does. Set descending for a code written with
+// SerializeDescending.
+inline size_t DictCodeLength(const rocksdb::Slice& in, bool descending) {
+  uint8_t flip = descending ? 0xFF : 0;
+  if (in.empty()) {
+    return 0;
+  }
+  size_t len = VarInt64Length((uint8_t) in[0] ^ flip);
+  if (len > in.size()) {
+    return 0;
+  }
+  // The low bit of the int's last byte says whether digits follow, and
+  // that of each digit whether another one does.
+  bool more = (((uint8_t) in[len - 1] ^ flip) & 1) != 0;
+  while (more) {
+    if (len == in.size()) {
+      return 0;
+    }
+    more = (((uint8_t) in[len++] ^ flip) & 1) != 0;
+  }
+  return len;
+}
+
+template<>
+inline size_t EncodedSize(const DictCode& c) {
+  return EncodedSize<VarInt64>(VarInt64(2 * c.n + !c.digits.empty())) +
+         c.digits.size();
+}
+
+template<>
+inline void Serialize(const DictCode& c, std::string& out) {
+  Serialize<VarInt64>(VarInt64(2 * c.n + !c.digits.empty()), out);
+  for (size_t i = 0; i < c.digits.size(); i++) {
+    bool more = i + 1 < c.digits.size();
+    out.push_back((char) ((uint8_t) c.digits[i] << 1 | more));
+  }
+}
+
+template<>
+inline DictCode Deserialize(rocksdb::Slice& in) {
+  int64_t head = Deserialize<VarInt64>(in).val;
+  // An arithmetic shift, so negative ints round down.
+  DictCode c(head >> 1);
+  bool more = (head & 1) != 0;
+  while (more) {
+    uint8_t b = in[0];
+    in.remove_prefix(1);
+    c.digits.push_back((char) (b >> 1));
+    more = (b & 1) != 0;
+  }
+  return c;
+}
+
+template<>
+inline DictCode DeserializeDescending(rocksdb::Slice& in) {
+  size_t len = DictCodeLength(in, true);
+  std::string buf(in.data(), len);
+  serialize_internal::InvertBytes(&buf[0], len);
+  in.remove_prefix(len);
+  rocksdb::Slice tmp(buf);
+  return Deserialize<DictCode>(tmp);
+}
+
+template<>
+inline void SkipEncoded<DictCode>(rocksdb::Slice& in) {
+  in.remove_prefix(DictCodeLength(in, false));
+}
+
+template<>
+inline void SkipEncodedDescending<DictCode>(rocksdb::Slice& in) {
+  in.remove_prefix(DictCodeLength(in, true));
+}
+
+// The smallest key that is greater than every key starting with prefix,
+// for use as an exclusive upper bound such as
+// ReadOptions::iterate_upper_bound. Trailing 0xFF bytes can't be
+// incremented and are dropped. Returns an empty string if prefix is all
+// 0xFF bytes, in which case there is no such bound.
+inline std::string PrefixSuccessor(const rocksdb::Slice& prefix) {
+  std::string result(prefix.data(), prefix.size());
+  while (!result.empty()) {
+    char& last = result.back();
+    if (static_cast<uint8_t>(last) != 0xFF) {
+      last++;
+      return result;
+    }
+    result.pop_back();
+  }
+  return result;
+}
+
+// Width of a key made of the columns Ts... kSize is the sum of the
+// fixed width columns, which is the whole key size when kFixed is true.
+template<typename... Ts>
+struct TupleWidth;
+
+template<>
+struct TupleWidth<> {
+  static const bool kFixed = true;
+  static const size_t kSize = 0;
+};
+
+template<typename T, typename... Ts>
+struct TupleWidth<T, Ts...> {
+  static const bool kFixed = EncodedWidth<T>::kFixed &&
+                             TupleWidth<Ts...>::kFixed;
+  static const size_t kSize = EncodedWidth<T>::kSize +
+                              TupleWidth<Ts...>::kSize;
+};
+
+namespace serialize_internal {
+
+// How one column of a tuple is encoded. Value is the decoded type.
+template<typename T>
+struct ColumnCodec {
+  typedef T Value;
+
+  static size_t Size(const T& val) { return EncodedSize<T>(val); }
+  static void Encode(const T& val, std::string& out) {
+    Serialize<T>(val, out);
+  }
+  static T Decode(rocksdb::Slice& in) { return Deserialize<T>(in); }
+  static void Skip(rocksdb::Slice& in) { SkipEncoded<T>(in); }
+};
+
+template<typename T>
+struct ColumnCodec<Descending<T>> {
+  typedef T Value;
+
+  static size_t Size(const Descending<T>& col) {
+    return EncodedSize<T>(col.val);
+  }
+  static void Encode(const Descending<T>& col, std::string& out) {
+    SerializeDescending<T>(col.val, out);
+  }
+  static T Decode(rocksdb::Slice& in) { return DeserializeDescending<T>(in); }
+  static void Skip(rocksdb::Slice& in) { SkipEncodedDescending<T>(in); }
+};
+
+template<size_t I, size_t N, typename Tuple>
+struct TupleCodec {
+  typedef typename std::decay<
+    typename std::tuple_element<I, Tuple>::type>::type Column;
+  typedef TupleCodec<I + 1, N, Tuple> Next;
+
+  static size_t Size(const Tuple& vals) {
+    return ColumnCodec<Column>::Size(std::get<I>(vals)) + Next::Size(vals);
+  }
+
+  static void Append(const Tuple& vals, std::string& out) {
+    ColumnCodec<Column>::Encode(std::get<I>(vals), out);
+    Next::Append(vals, out);
+  }
+};
+
+template<size_t N, typename Tuple>
+struct TupleCodec<N, N, Tuple> {
+  static size_t Size(const Tuple&) { return 0; }
+  static void Append(const Tuple&, std::string&) {}
+};
+
+}  // namespace serialize_internal
+
+// Number of bytes SerializeTuple(vals, out) appends to out. This folds
+// to a constant when every column is fixed width.
+template<typename... Ts>
+inline size_t EncodedSize(const std::tuple<Ts...>& vals) {
+  typedef serialize_internal::TupleCodec<0, sizeof...(Ts),
+                                         std::tuple<Ts...>> Codec;
+  return Codec::Size(vals);
+}
+
+// Serialize every column of vals into out, reserving the space for the
+// whole key up front. The bytes are identical to calling Serialize<T>
+// on each column in order. Use std::forward_as_tuple() to avoid copying
+// the columns into a temporary tuple.
+template<typename... Ts>
+inline void SerializeTuple(const std::tuple<Ts...>& vals, std::string& out) {
+  typedef serialize_internal::TupleCodec<0, sizeof...(Ts),
+                                         std::tuple<Ts...>> Codec;
+  out.reserve(out.size() + Codec::Size(vals));
+  Codec::Append(vals, out);
+}
+
+// Inverse of SerializeTuple. Columns are decoded left to right and
+// consumed from in.
+template<typename... Ts>
+inline std::tuple<typename serialize_internal::ColumnCodec<Ts>::Value...>
+DeserializeTuple(rocksdb::Slice& in) {
+  // Braced initialization guarantees left to right evaluation.
+  return std::tuple<typename serialize_internal::ColumnCodec<Ts>::Value...>{
+    serialize_internal::ColumnCodec<Ts>::Decode(in)...};
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <assert.h>
+
+#include <tuple>
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace serialize_internal {
+
+// Width of the first I columns of Tuple.
+template<size_t I, typename Tuple>
+struct PrefixWidth {
+  typedef typename std::tuple_element<I - 1, Tuple>::type Last;
+
+  static const bool kFixed = PrefixWidth<I - 1, Tuple>::kFixed &&
+                             EncodedWidth<Last>::kFixed;
+  static const size_t kSize = PrefixWidth<I - 1, Tuple>::kSize +
+                              EncodedWidth<Last>::kSize;
+};
+
+template<typename Tuple>
+struct PrefixWidth<0, Tuple> {
+  static const bool kFixed = true;
+  static const size_t kSize = 0;
+};
+
+}  // namespace serialize_internal
+
+// A read-only view of a key or value written with SerializeTuple that
+// decodes one column at a time:
+//
+//   TupleView<int64_t, std::string, int64_t> view(it->key());
+//   int64_t ts = view.get<2>();
+//
+// Columns behind a fixed width prefix are found at compile time offsets.
+// The first time a column after a variable length column is requested,
+// the offsets up to it are found by skipping over the columns before it
+// and remembered for later calls. The view doesn't own data, which must
+// outlive it; rocksdb::Slice columns point into it too, so they must not
+// contain NULs.
+template<typename... Ts>
+class TupleView {
+ public:
+  typedef std::tuple<Ts...> Columns;
+  typedef std::tuple<typename serialize_internal::ColumnCodec<Ts>::Value...>
+    Values;
+
+  static const size_t kNumColumns = sizeof...(Ts);
+
+  explicit TupleView(const rocksdb::Slice& data)
+    : data_(data), known_(0) {
+    offsets_[0] = 0;
+  }
+
+  // Decode column I.
+  template<size_t I>
+  typename std::tuple_element<I, Values>::type get() const {
+    typedef typename std::tuple_element<I, Columns>::type Column;
+    rocksdb::Slice in = column<I>();
+    return serialize_internal::ColumnCodec<Column>::Decode(in);
+  }
+
+  // The encoded bytes of the view from column I onwards.
+  template<size_t I>
+  rocksdb::Slice column() const {
+    static_assert(I < kNumColumns, "column index out of range");
+    typedef serialize_internal::PrefixWidth<I, Columns> Prefix;
+    size_t offset = Offset<I>(std::integral_constant<bool, Prefix::kFixed>());
+    assert(offset <= data_.size());
+    return rocksdb::Slice(data_.data() + offset, data_.size() - offset);
+  }
+
+  // Decode every column.
+  Values ToTuple() const {
+    rocksdb::Slice in = data_;
+    return DeserializeTuple<Ts...>(in);
+  }
+
+  const rocksdb::Slice& data() const { return data_; }
+
+ private:
+  typedef void (*SkipFn)(rocksdb::Slice&);
+
+  template<size_t I>
+  size_t Offset(std::true_type /* fixed prefix */) const {
+    return serialize_internal::PrefixWidth<I, Columns>::kSize;
+  }
+
+  template<size_t I>
+  size_t Offset(std::false_type /* fixed prefix */) const {
+    static const SkipFn skip[] = {
+      &serialize_internal::ColumnCodec<Ts>::Skip...
+    };
+    while (known_ < I) {
+      rocksdb::Slice in(data_.data() + offsets_[known_],
+                        data_.size() - offsets_[known_]);
+      skip[known_](in);
+      offsets_[known_ + 1] = in.data() - data_.data();
+      known_++;
+    }
+    return offsets_[I];
+  }
+
+  rocksdb::Slice data_;
+  // offsets_[0..known_] are the offsets of the columns found so far.
+  mutable size_t offsets_[kNumColumns + 1];
+  mutable size_t known_;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <rocksdb/iterator.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "rocksdb/utilities/serialize.h"
+
+// Iterates over rows whose keys and values were written with
+// SerializeTuple, decoding them straight into tuples:
+//
+//   TypedIterator<std::tuple<int64_t, rocksdb::Slice>,
+//                 std::tuple<double>> it(db->NewIterator(ReadOptions()));
+//   for (it.SeekPrefix(std::make_tuple(int64_t(1))); it.Valid(); it.Next()) {
+//     int64_t id = std::get<0>(it.key());
+//     ...
+//   }
+//
+// Columns may be wrapped in Descending<T>. Decoding does not allocate for
+// fixed width and rocksdb::Slice columns; the Slices point into the
+// underlying iterator and are valid until it moves, so they can't hold
+// strings with NULs; decode columns that may contain NULs as std::string.
+// Bounds are compared bytewise, so the DB must use the default comparator.
+template<typename Key, typename Value>
+class TypedIterator;
+
+template<typename... K, typename... V>
+class TypedIterator<std::tuple<K...>, std::tuple<V...>> {
+ public:
+  typedef std::tuple<typename serialize_internal::ColumnCodec<K>::Value...>
+    KeyTuple;
+  typedef std::tuple<typename serialize_internal::ColumnCodec<V>::Value...>
+    ValueTuple;
+
+  // Takes ownership of it.
+  explicit TypedIterator(rocksdb::Iterator* it)
+    : it_(it), key_decoded_(false), value_decoded_(false) {}
+
+  // Only visit keys that start with the encoded prefix.
+  void SetPrefix(const rocksdb::Slice& prefix) {
+    prefix_.assign(prefix.data(), prefix.size());
+  }
+
+  // Only visit keys that sort before the encoded upper bound.
+  void SetUpperBound(const rocksdb::Slice& upper_bound) {
+    upper_bound_.assign(upper_bound.data(), upper_bound.size());
+  }
+
+  void SeekToFirst() {
+    Moved();
+    if (prefix_.empty()) {
+      it_->SeekToFirst();
+    } else {
+      it_->Seek(prefix_);
+    }
+  }
+
+  void Seek(const rocksdb::Slice& target) {
+    Moved();
+    it_->Seek(target);
+  }
+
+  // Seek to the first key at or after the leading columns in key.
+  template<typename... Ts>
+  void Seek(const std::tuple<Ts...>& key) {
+    seek_key_.clear();
+    SerializeTuple(key, seek_key_);
+    Seek(seek_key_);
+  }
+
+  // Restrict iteration to keys whose leading columns equal prefix, and
+  // seek to the first of them.
+  template<typename... Ts>
+  void SeekPrefix(const std::tuple<Ts...>& prefix) {
+    prefix_.clear();
+    SerializeTuple(prefix, prefix_);
+    SeekToFirst();
+  }
+
+  void Next() {
+    Moved();
+    it_->Next();
+  }
+
+  bool Valid() const {
+    if (!it_->Valid()) {
+      return false;
+    }
+    rocksdb::Slice k = it_->key();
+    return (prefix_.empty() || k.starts_with(prefix_)) &&
+           (upper_bound_.empty() || k.compare(upper_bound_) < 0);
+  }
+
+  // The decoded key and value of the current row. Each is decoded at
+  // most once per position.
+  const KeyTuple& key() {
+    if (!key_decoded_) {
+      rocksdb::Slice k = it_->key();
+      key_ = DeserializeTuple<K...>(k);
+      key_decoded_ = true;
+    }
+    return key_;
+  }
+
+  const ValueTuple& value() {
+    if (!value_decoded_) {
+      rocksdb::Slice v = it_->value();
+      value_ = DeserializeTuple<V...>(v);
+      value_decoded_ = true;
+    }
+    return value_;
+  }
+
+  rocksdb::Slice raw_key() const { return it_->key(); }
+  rocksdb::Slice raw_value() const { return it_->value(); }
+  rocksdb::Status status() const { return it_->status(); }
+
+ private:
+  void Moved() {
+    key_decoded_ = false;
+    value_decoded_ = false;
+  }
+
+  std::unique_ptr<rocksdb::Iterator> it_;
+  std::string prefix_;
+  std::string upper_bound_;
+  std::string seek_key_;
+  KeyTuple key_;
+  ValueTuple value_;
+  bool key_decoded_;
+  bool value_decoded_;
+};
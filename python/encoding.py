@@ -15,6 +15,56 @@ def encodeInt64(i):
     if (i < 0): i = i & 0xFFFFFFFFFFFFFFFF
     return struct.pack('>Q', i ^ mask)
 
+def encodeSigned(i, bits):
+    """ Big-endian at the given width, with the sign bit flipped. Used
+        for int8 to int32 columns, like encodeInt64.
+    """
+    mask = 1 << (bits - 1)
+    return ((i & ((1 << bits) - 1)) ^ mask).to_bytes(bits // 8, 'big')
+
+def encodeUnsigned(i, bits):
+    """ Plain big-endian, for uint8 to uint64 columns. """
+    return i.to_bytes(bits // 8, 'big')
+
+def encodeInt8(i): return encodeSigned(i, 8)
+def encodeInt16(i): return encodeSigned(i, 16)
+def encodeInt32(i): return encodeSigned(i, 32)
+def encodeUInt8(i): return encodeUnsigned(i, 8)
+def encodeUInt16(i): return encodeUnsigned(i, 16)
+def encodeUInt32(i): return encodeUnsigned(i, 32)
+def encodeUInt64(i): return encodeUnsigned(i, 64)
+
+def encodeTimestamp(micros):
+    """ Microseconds since the epoch, encoded like an int64. """
+    return encodeInt64(micros)
+
+def encodeVarInt64(i):
+    """ Order preserving variable length encoding. The first byte orders
+        values by length: 0x00-0x07 are negative and followed by 8 - b
+        bytes, 0x08-0xF7 hold 0 to 239 directly, and 0xF8-0xFF are
+        followed by b - 0xF7 bytes. The trailing bytes are the low bytes
+        of the value, big-endian.
+    """
+    if 0 <= i <= 239:
+        return struct.pack('B', 0x08 + i)
+    u = ~i if i < 0 else i
+    n = max(1, (u.bit_length() + 7) // 8)
+    prefix = 0x08 - n if i < 0 else 0xF7 + n
+    payload = struct.pack('>Q', i & 0xFFFFFFFFFFFFFFFF)[8 - n:]
+    return struct.pack('B', prefix) + payload
+
+def encodeDictCode(n, digits=()):
+    """ The code of a string in an order preserving dictionary, assigned
+        in the order of the strings: the int n and base 128 fraction
+        digits, the last of which isn't 0. The int is encoded as the
+        VarInt64 2n + 1 if there are digits and 2n otherwise, and each
+        digit d as d << 1, with the low bit set on all but the last.
+    """
+    out = encodeVarInt64(2 * n + (1 if digits else 0))
+    for i, d in enumerate(digits):
+        out += struct.pack('B', d << 1 | (1 if i + 1 < len(digits) else 0))
+    return out
+
 def encodeBool(b):
     return struct.pack('b', b)
 
@@ -23,14 +73,35 @@ def encodeDouble(d):
         Explains why the algorithm below works. Look for the explanation under
         fixed-length 64-bit float.
     """
+    if d == 0: d = 0.0  # -0.0 would sort below every negative number
     mask = 0xFFFFFFFFFFFFFFFF
     if (d >= 0): mask = 0x8000000000000000
     i = struct.unpack('Q', struct.pack('d', d))[0]
     return struct.pack('>Q', i ^ mask)
 
+def encodeFloat(f):
+    """ The 32-bit version of encodeDouble. """
+    if f == 0: f = 0.0
+    mask = 0xFFFFFFFF
+    if (f >= 0): mask = 0x80000000
+    i = struct.unpack('I', struct.pack('f', f))[0]
+    return struct.pack('>I', i ^ mask)
+
 def encodeString(s):
-    s = bytes(s, 'utf-8')
-    return struct.pack('%ds' % len(s), s) + struct.pack('c', bytes(1))
+    """ NULs are escaped as \\x00\\xff and the string is terminated by
+        \\x00\\x01, so embedded NULs sort before any other byte and can't
+        be confused with the end of the string.
+    """
+    s = bytes(s, 'utf-8').replace(b'\x00', b'\x00\xff')
+    return struct.pack('%ds' % len(s), s) + b'\x00\x01'
+
+def encodeFixedString(s, n):
+    """ A char(n) column: the bytes of the string padded with NULs to n.
+        Longer strings are cut to n bytes and trailing NULs are lost, so
+        ldb rejects such values.
+    """
+    s = bytes(s, 'utf-8')[:n]
+    return s + bytes(n - len(s))
 
 generators = [ lambda: (yield random.randint(-sys.maxsize, sys.maxsize)),
                lambda: (yield random.uniform(sys.float_info.min, sys.float_info.max) * random.choice([1, -1])),
@@ -46,11 +117,45 @@ class SerializeTests(unittest.TestCase):
             self.assertEqual(i1 < i2, encodeInt64(i1) < encodeInt64(i2))
 
 
+    def test_varints(self):
+        for i in range(1000):
+            i1 = list(generators[0]())[0] >> random.randint(0, 63)
+            i2 = list(generators[0]())[0] >> random.randint(0, 63)
+            self.assertEqual(i1 < i2, encodeVarInt64(i1) < encodeVarInt64(i2))
+        self.assertEqual(b'\x08', encodeVarInt64(0))
+        self.assertEqual(b'\xf7', encodeVarInt64(239))
+        self.assertEqual(b'\xf8\xf0', encodeVarInt64(240))
+        self.assertEqual(b'\x07\xff', encodeVarInt64(-1))
+        self.assertEqual(b'\x00\x80' + bytes(7), encodeVarInt64(-2**63))
+
+    def test_narrow_ints(self):
+        for bits, signed in [(8, True), (16, True), (32, True),
+                             (8, False), (16, False), (32, False), (64, False)]:
+            lo = -(1 << (bits - 1)) if signed else 0
+            hi = (1 << (bits - 1)) - 1 if signed else (1 << bits) - 1
+            encode = (lambda i: encodeSigned(i, bits)) if signed else (lambda i: encodeUnsigned(i, bits))
+            for i in range(1000):
+                i1 = random.randint(lo, hi)
+                i2 = random.randint(lo, hi)
+                self.assertEqual(i1 < i2, encode(i1) < encode(i2))
+        self.assertEqual(b'\x80\x00\x00\x05', encodeInt32(5))
+        self.assertEqual(b'\x7f\xff', encodeInt16(-1))
+
+    def test_floats(self):
+        for i in range(1000):
+            f1 = struct.unpack('f', struct.pack('f', random.uniform(-1e30, 1e30)))[0]
+            f2 = struct.unpack('f', struct.pack('f', random.uniform(-1e30, 1e30)))[0]
+            self.assertEqual(f1 < f2, encodeFloat(f1) < encodeFloat(f2))
+        self.assertEqual(encodeFloat(0.0), encodeFloat(-0.0))
+        self.assertLess(encodeFloat(-1e-40), encodeFloat(-0.0))
+
     def test_doubles(self):
         for i in range(1000):
             i1 = list(generators[1]())[0]
             i2 = list(generators[1]())[0]
             self.assertEqual(i1 < i2, encodeDouble(i1) < encodeDouble(i2))
+        self.assertEqual(encodeDouble(0.0), encodeDouble(-0.0))
+        self.assertLess(encodeDouble(-5e-324), encodeDouble(-0.0))
 
     def test_strings(self):
         for i in range(1000):
@@ -58,9 +163,24 @@ class SerializeTests(unittest.TestCase):
             i2 = list(generators[3]())[0]
             self.assertEqual(i1 < i2, encodeString(i1) < encodeString(i2))
 
+    def test_strings_with_nul(self):
+        for i in range(1000):
+            i1 = ''.join(random.choice('\x00\x01ab') for i in range(random.randint(0, 8)))
+            i2 = ''.join(random.choice('\x00\x01ab') for i in range(random.randint(0, 8)))
+            self.assertEqual(i1 < i2, encodeString(i1) < encodeString(i2))
+
+    def test_fixed_strings(self):
+        for i in range(1000):
+            i1 = list(generators[3]())[0][:16]
+            i2 = list(generators[3]())[0][:16]
+            self.assertEqual(i1 < i2, encodeFixedString(i1, 16) < encodeFixedString(i2, 16))
+        self.assertEqual(b'ab\x00\x00', encodeFixedString('ab', 4))
+
 def visualize():
     print(encodeInt64(4))
     print(encodeInt64(-4))
+    print(encodeVarInt64(4))
+    print(encodeVarInt64(-4))
     print(encodeBool(True))
     print(encodeBool(False))
     print(encodeDouble(4.01))
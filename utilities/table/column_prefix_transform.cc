@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/column_prefix_transform.h"
+
+#include <assert.h>
+
+namespace rocksdb { namespace table {
+
+ColumnPrefixTransform::ColumnPrefixTransform(
+    const std::vector<ColumnSpec>& columns)
+  : columns_(columns), name_("rocksdb.table.ColumnPrefix:") {
+  for (const auto& c : columns_) {
+    name_.append(std::to_string(static_cast<int>(c.type)));
+    if (c.encoding == ColumnEncoding::kVarint) {
+      name_.push_back('v');
+    }
+    if (c.encoding == ColumnEncoding::kFixed) {
+      name_.push_back('f');
+      name_.append(std::to_string(c.width));
+    }
+    if (c.encoding == ColumnEncoding::kDictionary) {
+      name_.push_back('D');
+    }
+    if (c.encoding >= ColumnEncoding::kInt8) {
+      name_.push_back('e');
+      name_.append(std::to_string(static_cast<int>(c.encoding)));
+    }
+    if (c.descending) {
+      name_.push_back('d');
+    }
+    name_.push_back(',');
+  }
+}
+
+ptrdiff_t ColumnPrefixTransform::PrefixLength(const Slice& key) const {
+  Slice in = key;
+  for (const auto& c : columns_) {
+    if (!SkipColumn(c, &in)) {
+      return -1;
+    }
+  }
+  return in.data() - key.data();
+}
+
+Slice ColumnPrefixTransform::Transform(const Slice& key) const {
+  ptrdiff_t len = PrefixLength(key);
+  assert(len >= 0);
+  return Slice(key.data(), len < 0 ? key.size() : len);
+}
+
+bool ColumnPrefixTransform::InDomain(const Slice& key) const {
+  return PrefixLength(key) >= 0;
+}
+
+bool ColumnPrefixTransform::InRange(const Slice& dst) const {
+  return PrefixLength(dst) == static_cast<ptrdiff_t>(dst.size());
+}
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,48 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/slice_transform.h"
+#include "utilities/table/table_schema.h"
+
+namespace rocksdb { namespace table {
+
+// A prefix extractor that takes the first columns of keys encoded with
+// the table encoding, e.g. the entity id and schema id of a hierarchical
+// clustered DB. Set as Options::prefix_extractor, it enables prefix bloom
+// filters in SST files and memtables, and prefix_same_as_start scans
+// over one entity.
+//
+// String columns are found by their terminator, so the prefix of a key
+// has no fixed length. Keys with fewer columns than the prefix are
+// outside the domain and are not added to the bloom filters.
+class ColumnPrefixTransform : public SliceTransform {
+ public:
+  explicit ColumnPrefixTransform(const std::vector<ColumnSpec>& columns);
+
+  virtual const char* Name() const override { return name_.c_str(); }
+
+  virtual Slice Transform(const Slice& key) const override;
+
+  virtual bool InDomain(const Slice& key) const override;
+
+  // dst is a complete prefix.
+  virtual bool InRange(const Slice& dst) const override;
+
+ private:
+  // Length of the prefix of key, or -1 if key doesn't have all columns.
+  ptrdiff_t PrefixLength(const Slice& key) const;
+
+  std::vector<ColumnSpec> columns_;
+  // Identifies the columns, so that a DB opened with a different prefix
+  // doesn't use filters built for this one.
+  std::string name_;
+};
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/column_prefix_transform.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+const ColumnSpec kString = {Dynamic::T_STRING, false,
+                            ColumnEncoding::kDefault, 0};
+const ColumnSpec kDescString = {Dynamic::T_STRING, true,
+                                ColumnEncoding::kDefault, 0};
+
+}  // namespace
+
+TEST(ColumnPrefixTransform, FixedWidthColumns) {
+  ColumnPrefixTransform transform({kInt, kInt});
+  std::string key;
+  Serialize<int64_t>(1, key);
+  Serialize<int64_t>(2, key);
+  std::string prefix = key;
+  Serialize<std::string>("row", key);
+
+  EXPECT_TRUE(transform.InDomain(key));
+  EXPECT_EQ(Slice(prefix), transform.Transform(key));
+  EXPECT_TRUE(transform.InDomain(prefix));
+  EXPECT_EQ(Slice(prefix), transform.Transform(prefix));
+  EXPECT_TRUE(transform.InRange(prefix));
+  EXPECT_FALSE(transform.InRange(key));
+
+  // A key with only the first column, or cut inside the second.
+  EXPECT_FALSE(transform.InDomain(Slice(key.data(), 8)));
+  EXPECT_FALSE(transform.InDomain(Slice(key.data(), 12)));
+  EXPECT_FALSE(transform.InRange(Slice(key.data(), 8)));
+}
+
+TEST(ColumnPrefixTransform, StringColumns) {
+  ColumnPrefixTransform transform({kString, kDescString});
+  std::string key;
+  Serialize<std::string>(std::string("a\0b", 3), key);
+  SerializeDescending<std::string>("cd", key);
+  std::string prefix = key;
+  Serialize<int64_t>(3, key);
+
+  EXPECT_TRUE(transform.InDomain(key));
+  EXPECT_EQ(Slice(prefix), transform.Transform(key));
+  EXPECT_TRUE(transform.InRange(prefix));
+
+  // The same strings with another row key share the prefix.
+  std::string other = prefix;
+  Serialize<int64_t>(4, other);
+  EXPECT_EQ(transform.Transform(key), transform.Transform(other));
+
+  // Without the terminator of the last string the key has no prefix.
+  EXPECT_FALSE(transform.InDomain(Slice(prefix.data(), prefix.size() - 1)));
+  EXPECT_FALSE(transform.InDomain(Slice(prefix.data(), 3)));
+  EXPECT_FALSE(transform.InDomain(""));
+}
+
+TEST(ColumnPrefixTransform, NameIdentifiesColumns) {
+  ColumnSpec varint = kInt;
+  varint.encoding = ColumnEncoding::kVarint;
+  ColumnSpec fixed = kString;
+  fixed.encoding = ColumnEncoding::kFixed;
+  fixed.width = 4;
+  ColumnSpec wider = fixed;
+  wider.width = 8;
+  ColumnSpec narrow = kInt;
+  narrow.encoding = ColumnEncoding::kInt16;
+
+  std::vector<std::vector<ColumnSpec>> prefixes = {
+    {kInt}, {kInt, kInt}, {kString}, {kDescString}, {varint}, {fixed},
+    {wider}, {narrow}, {kInt, kString}, {kString, kInt},
+  };
+  std::vector<std::string> names;
+  for (const auto& columns : prefixes) {
+    names.push_back(ColumnPrefixTransform(columns).Name());
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    for (size_t j = i + 1; j < names.size(); j++) {
+      EXPECT_NE(names[i], names[j]);
+    }
+  }
+  EXPECT_EQ(names[0], std::string(ColumnPrefixTransform({kInt}).Name()));
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,236 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/input_parser.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <limits>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/string_dictionary.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+template<typename T>
+void EncodeValue(const T& val, bool descending, std::string* out) {
+  if (descending) {
+    SerializeDescending<T>(val, *out);
+  } else {
+    Serialize<T>(val, *out);
+  }
+}
+
+bool IsQuoted(const Slice& token) {
+  return token.size() >= 2 && token[0] == '"' &&
+         token[token.size() - 1] == '"';
+}
+
+}  // namespace
+
+Status MappedFile::Open(const std::string& path,
+                        std::unique_ptr<MappedFile>* file) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Status::IOError(path, strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    return Status::IOError(path, strerror(err));
+  }
+  size_t size = st.st_size;
+  void* data = nullptr;
+  // mmap rejects empty mappings.
+  if (size > 0) {
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      int err = errno;
+      close(fd);
+      return Status::IOError(path, strerror(err));
+    }
+    // The file is read front to back once.
+    madvise(data, size, MADV_SEQUENTIAL);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  file->reset(new MappedFile(static_cast<const char*>(data), size));
+  return Status::OK();
+}
+
+MappedFile::~MappedFile() {
+  if (size_ > 0) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+Slice NextLine(Slice* data) {
+  const char* begin = data->data();
+  const char* nl =
+    static_cast<const char*>(memchr(begin, '\n', data->size()));
+  size_t len = nl ? nl - begin : data->size();
+  data->remove_prefix(nl ? len + 1 : len);
+  if (len > 0 && begin[len - 1] == '\r') {
+    len--;
+  }
+  return Slice(begin, len);
+}
+
+void SplitTokens(const Slice& line, std::vector<Slice>* tokens) {
+  const char* p = line.data();
+  const char* end = p + line.size();
+  while (p < end) {
+    if (*p == ' ') {
+      p++;
+      continue;
+    }
+    const char* sp = static_cast<const char*>(memchr(p, ' ', end - p));
+    const char* token_end = sp ? sp : end;
+    tokens->emplace_back(p, token_end - p);
+    p = token_end;
+  }
+}
+
+bool ParseInt64(const Slice& token, int64_t* val) {
+  const char* p = token.data();
+  const char* end = p + token.size();
+  bool negative = p < end && *p == '-';
+  if (negative || (p < end && *p == '+')) {
+    p++;
+  }
+  if (p == end) {
+    return false;
+  }
+  // Accumulate the magnitude unsigned so that the minimum int64 parses.
+  const uint64_t limit =
+    negative ? uint64_t(std::numeric_limits<int64_t>::max()) + 1
+             : uint64_t(std::numeric_limits<int64_t>::max());
+  uint64_t v = 0;
+  for (; p < end; p++) {
+    unsigned digit = static_cast<unsigned char>(*p) - '0';
+    if (digit > 9 || v > (limit - digit) / 10) {
+      return false;
+    }
+    v = v * 10 + digit;
+  }
+  *val = negative ? static_cast<int64_t>(0 - v) : static_cast<int64_t>(v);
+  return true;
+}
+
+bool ParseDouble(const Slice& token, double* val) {
+  // strtod needs a terminated string; any double fits in this buffer.
+  // It also skips leading white space, which ParseInt64 rejects.
+  char buf[64];
+  if (token.empty() || token.size() >= sizeof(buf) ||
+      isspace(static_cast<unsigned char>(token[0]))) {
+    return false;
+  }
+  memcpy(buf, token.data(), token.size());
+  buf[token.size()] = '\0';
+  char* end;
+  errno = 0;
+  *val = strtod(buf, &end);
+  return errno == 0 && end == buf + token.size();
+}
+
+ColumnSpec TokenSpec(const Slice& token) {
+  ColumnSpec spec = {IsQuoted(token) ? Dynamic::T_STRING : Dynamic::T_INT,
+                     false, ColumnEncoding::kDefault, 0};
+  return spec;
+}
+
+namespace {
+
+// EncodeToken and EncodeLookupToken, which differ in whether strings
+// missing from a dictionary are added.
+Status EncodeTokenTo(const ColumnSpec& spec, const Slice& token,
+                     bool add_strings, std::string* out) {
+  switch (spec.type) {
+    case Dynamic::T_BLANK:
+      return Status::OK();
+    case Dynamic::T_BOOL: {
+      int64_t v;
+      if (token == Slice("true") || token == Slice("false")) {
+        v = token == Slice("true");
+      } else if (!ParseInt64(token, &v)) {
+        return Status::InvalidArgument("not a bool", token);
+      }
+      EncodeValue<bool>(v != 0, spec.descending, out);
+      return Status::OK();
+    }
+    case Dynamic::T_DOUBLE: {
+      double v;
+      if (!ParseDouble(token, &v)) {
+        return Status::InvalidArgument("not a double", token);
+      }
+      if (spec.encoding != ColumnEncoding::kDefault) {
+        return EncodeColumn(spec, Dynamic(v), out);
+      }
+      EncodeValue<double>(v, spec.descending, out);
+      return Status::OK();
+    }
+    case Dynamic::T_INT: {
+      int64_t v;
+      if (!ParseInt64(token, &v)) {
+        return Status::InvalidArgument("not an int", token);
+      }
+      if (spec.encoding == ColumnEncoding::kVarint) {
+        EncodeValue<VarInt64>(v, spec.descending, out);
+      } else if (spec.encoding == ColumnEncoding::kDefault) {
+        EncodeValue<int64_t>(v, spec.descending, out);
+      } else {
+        // The narrower encodings check the range of v.
+        return EncodeColumn(spec, Dynamic(v), out);
+      }
+      return Status::OK();
+    }
+    case Dynamic::T_STRING:
+    case Dynamic::T_SLICE: {
+      Slice str = token;
+      if (IsQuoted(token)) {
+        str = Slice(token.data() + 1, token.size() - 2);
+      } else if (!token.empty() && token[0] == '"') {
+        return Status::InvalidArgument("unterminated string", token);
+      }
+      if (spec.encoding == ColumnEncoding::kDictionary) {
+        DictCode code;
+        Status st = add_strings ? spec.dictionary->Intern(str, &code)
+                                : spec.dictionary->Find(str, &code);
+        if (st.ok()) {
+          EncodeValue<DictCode>(code, spec.descending, out);
+        }
+        return st;
+      }
+      if (spec.encoding == ColumnEncoding::kFixed) {
+        return EncodeFixedString(spec, str, out);
+      }
+      EncodeValue<Slice>(str, spec.descending, out);
+      return Status::OK();
+    }
+  }
+  return Status::NotSupported("unknown column type");
+}
+
+}  // namespace
+
+Status EncodeToken(const ColumnSpec& spec, const Slice& token,
+                   std::string* out) {
+  return EncodeTokenTo(spec, token, true, out);
+}
+
+Status EncodeLookupToken(const ColumnSpec& spec, const Slice& token,
+                         std::string* out) {
+  return EncodeTokenTo(spec, token, false, out);
+}
+
+}}  // namespace rocksdb::table
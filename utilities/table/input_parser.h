@@ -0,0 +1,65 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "utilities/table/table_schema.h"
+
+namespace rocksdb { namespace table {
+
+// A whole file mapped read-only into memory.
+class MappedFile {
+ public:
+  static Status Open(const std::string& path,
+                     std::unique_ptr<MappedFile>* file);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  Slice data() const { return Slice(data_, size_); }
+
+ private:
+  MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+
+  const char* data_;
+  size_t size_;
+};
+
+// Remove the first line from *data and return it without its line end.
+Slice NextLine(Slice* data);
+
+// Append the space separated tokens of line to *tokens. The tokens point
+// into line.
+void SplitTokens(const Slice& line, std::vector<Slice>* tokens);
+
+// Parse all of token as a decimal number. Like std::from_chars, these
+// need neither a terminating NUL nor a locale, and fail on trailing
+// characters or overflow.
+bool ParseInt64(const Slice& token, int64_t* val);
+bool ParseDouble(const Slice& token, double* val);
+
+// The column spec of an input token when there is no schema: a quoted
+// token is a string and anything else is an int.
+ColumnSpec TokenSpec(const Slice& token);
+
+// Parse the input token as a value of the column spec and append its
+// encoding to out. Strings are copied straight from the token, and
+// strings of a dictionary column missing from the dictionary are added.
+Status EncodeToken(const ColumnSpec& spec, const Slice& token,
+                   std::string* out);
+
+// Like EncodeToken, for a key to look up or a range bound rather than a
+// row to write: a string missing from the dictionary of its column is
+// not added, and is encoded as a code no row has that sorts like it.
+Status EncodeLookupToken(const ColumnSpec& spec, const Slice& token,
+                         std::string* out);
+
+}}  // namespace rocksdb::table
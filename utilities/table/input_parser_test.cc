@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/input_parser.h"
+#include "utilities/table/string_dictionary.h"
+
+using ::testing::InitGoogleTest;
+using rocksdb::Slice;
+using namespace rocksdb::table;
+
+TEST(ParseInt64, Basic) {
+  int64_t v;
+  EXPECT_TRUE(ParseInt64("0", &v));
+  EXPECT_EQ(0, v);
+  EXPECT_TRUE(ParseInt64("123", &v));
+  EXPECT_EQ(123, v);
+  EXPECT_TRUE(ParseInt64("+7", &v));
+  EXPECT_EQ(7, v);
+  EXPECT_TRUE(ParseInt64("-42", &v));
+  EXPECT_EQ(-42, v);
+  EXPECT_TRUE(ParseInt64("-0", &v));
+  EXPECT_EQ(0, v);
+}
+
+TEST(ParseInt64, Limits) {
+  int64_t v;
+  EXPECT_TRUE(ParseInt64("9223372036854775807", &v));
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), v);
+  EXPECT_TRUE(ParseInt64("-9223372036854775808", &v));
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), v);
+  EXPECT_FALSE(ParseInt64("9223372036854775808", &v));
+  EXPECT_FALSE(ParseInt64("-9223372036854775809", &v));
+  EXPECT_FALSE(ParseInt64("99999999999999999999", &v));
+}
+
+TEST(ParseInt64, Rejects) {
+  int64_t v = 5;
+  EXPECT_FALSE(ParseInt64("", &v));
+  EXPECT_FALSE(ParseInt64("-", &v));
+  EXPECT_FALSE(ParseInt64("+", &v));
+  EXPECT_FALSE(ParseInt64("--1", &v));
+  EXPECT_FALSE(ParseInt64("1a", &v));
+  EXPECT_FALSE(ParseInt64(" 1", &v));
+  EXPECT_FALSE(ParseInt64("1.0", &v));
+  EXPECT_FALSE(ParseInt64("\"1\"", &v));
+  EXPECT_EQ(5, v);
+}
+
+TEST(ParseInt64, DoesNotReadPastToken) {
+  std::string line = "12 34";
+  int64_t v;
+  EXPECT_TRUE(ParseInt64(Slice(line.data(), 2), &v));
+  EXPECT_EQ(12, v);
+  EXPECT_FALSE(ParseInt64(Slice(line.data(), 3), &v));
+}
+
+TEST(ParseDouble, Basic) {
+  double v;
+  EXPECT_TRUE(ParseDouble("1.5", &v));
+  EXPECT_EQ(1.5, v);
+  EXPECT_TRUE(ParseDouble("-2", &v));
+  EXPECT_EQ(-2.0, v);
+  EXPECT_TRUE(ParseDouble("+0.25", &v));
+  EXPECT_EQ(0.25, v);
+  EXPECT_TRUE(ParseDouble("1e3", &v));
+  EXPECT_EQ(1000.0, v);
+  EXPECT_TRUE(ParseDouble("-0.0", &v));
+  EXPECT_TRUE(std::signbit(v));
+}
+
+TEST(ParseDouble, Rejects) {
+  double v;
+  EXPECT_FALSE(ParseDouble("", &v));
+  EXPECT_FALSE(ParseDouble("-", &v));
+  EXPECT_FALSE(ParseDouble("1.5x", &v));
+  EXPECT_FALSE(ParseDouble(" 1.5", &v));
+  EXPECT_FALSE(ParseDouble("1e999", &v));
+  EXPECT_FALSE(ParseDouble("-1e999", &v));
+  EXPECT_FALSE(ParseDouble(std::string(64, '1'), &v));
+}
+
+TEST(ParseDouble, DoesNotReadPastToken) {
+  std::string line = "1.5 2";
+  double v;
+  EXPECT_TRUE(ParseDouble(Slice(line.data(), 3), &v));
+  EXPECT_EQ(1.5, v);
+  EXPECT_FALSE(ParseDouble(Slice(line.data(), 5), &v));
+}
+
+TEST(SplitTokens, SkipsRepeatedSpaces) {
+  std::vector<Slice> tokens;
+  SplitTokens("  1 \"a\"  ==> 2 ", &tokens);
+  ASSERT_EQ(4U, tokens.size());
+  EXPECT_EQ(Slice("1"), tokens[0]);
+  EXPECT_EQ(Slice("\"a\""), tokens[1]);
+  EXPECT_EQ(Slice("==>"), tokens[2]);
+  EXPECT_EQ(Slice("2"), tokens[3]);
+}
+
+TEST(NextLine, StripsLineEnds) {
+  Slice data("a b\r\n\nc");
+  EXPECT_EQ(Slice("a b"), NextLine(&data));
+  EXPECT_EQ(Slice(""), NextLine(&data));
+  EXPECT_EQ(Slice("c"), NextLine(&data));
+  EXPECT_TRUE(data.empty());
+}
+
+TEST(EncodeToken, TypesFromSpec) {
+  ColumnSpec int_spec = {rocksdb::Dynamic::T_INT, false,
+                         ColumnEncoding::kDefault, 0};
+  ColumnSpec double_spec = {rocksdb::Dynamic::T_DOUBLE, false,
+                            ColumnEncoding::kDefault, 0};
+  ColumnSpec bool_spec = {rocksdb::Dynamic::T_BOOL, false,
+                          ColumnEncoding::kDefault, 0};
+  std::string out;
+  std::string expected;
+
+  ASSERT_TRUE(EncodeToken(int_spec, "-3", &out).ok());
+  Serialize<int64_t>(-3, expected);
+  ASSERT_TRUE(EncodeToken(double_spec, "2.5", &out).ok());
+  Serialize<double>(2.5, expected);
+  ASSERT_TRUE(EncodeToken(bool_spec, "true", &out).ok());
+  Serialize<bool>(true, expected);
+  ASSERT_TRUE(EncodeToken(TokenSpec("\"ab\""), "\"ab\"", &out).ok());
+  Serialize<std::string>("ab", expected);
+  EXPECT_EQ(expected, out);
+
+  EXPECT_FALSE(EncodeToken(int_spec, "2.5", &out).ok());
+  EXPECT_FALSE(EncodeToken(double_spec, "x", &out).ok());
+  EXPECT_FALSE(EncodeToken(TokenSpec("\"ab"), "\"ab", &out).ok());
+}
+
+TEST(EncodeToken, FixedString) {
+  ColumnSpec spec = {rocksdb::Dynamic::T_STRING, false,
+                     ColumnEncoding::kFixed, 4};
+  std::string out;
+  ASSERT_TRUE(EncodeToken(spec, "\"ab\"", &out).ok());
+  EXPECT_EQ(std::string("ab\0\0", 4), out);
+
+  // Too long, or ending in a NUL that the padding would hide.
+  out.clear();
+  EXPECT_TRUE(EncodeToken(spec, "abcde", &out).IsInvalidArgument());
+  EXPECT_TRUE(
+      EncodeToken(spec, Slice("ab\0", 3), &out).IsInvalidArgument());
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(EncodeLookupToken, DoesNotAddStrings) {
+  ColumnSpec spec = {rocksdb::Dynamic::T_STRING, false,
+                     ColumnEncoding::kDictionary, 0};
+  spec.dictionary = std::make_shared<StringDictionary>("country");
+  std::string de;
+  std::string us;
+  ASSERT_TRUE(EncodeToken(spec, "\"DE\"", &de).ok());
+  ASSERT_TRUE(EncodeToken(spec, "\"US\"", &us).ok());
+
+  // A string in the dictionary has its own code.
+  std::string out;
+  ASSERT_TRUE(EncodeLookupToken(spec, "\"US\"", &out).ok());
+  EXPECT_EQ(us, out);
+
+  // Missing strings sort like they would, match no string, and stay
+  // missing.
+  for (const char* token : {"\"AT\"", "\"FR\"", "\"ZA\""}) {
+    out.clear();
+    ASSERT_TRUE(EncodeLookupToken(spec, token, &out).ok());
+    EXPECT_EQ(std::string(token) < "\"DE\"", out < de) << token;
+    EXPECT_EQ(std::string(token) < "\"US\"", out < us) << token;
+    Slice in(out);
+    std::string str;
+    EXPECT_TRUE(spec.dictionary->Lookup(Deserialize<DictCode>(in), &str)
+                    .IsCorruption()) << token;
+  }
+  std::string fr;
+  ASSERT_TRUE(EncodeToken(spec, "\"FR\"", &fr).ok());
+  EXPECT_LT(de, fr);
+  EXPECT_LT(fr, us);
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
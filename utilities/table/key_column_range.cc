@@ -0,0 +1,39 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/key_column_range.h"
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+KeyColumnRange::KeyColumnRange(const std::vector<ColumnSpec>& leading,
+                               const std::string& lower,
+                               const std::string& upper)
+  : leading_(leading),
+    lower_(lower),
+    upper_successor_(upper.empty() ? std::string()
+                                   : PrefixSuccessor(upper)) {}
+
+KeyColumnRange::Position KeyColumnRange::Locate(const Slice& key,
+                                                Slice* leading) const {
+  Slice rest = key;
+  for (const auto& spec : leading_) {
+    if (!SkipColumn(spec, &rest)) {
+      return kIncomplete;
+    }
+  }
+  if (rest.empty()) {
+    return kIncomplete;
+  }
+  *leading = Slice(key.data(), rest.data() - key.data());
+  if (!lower_.empty() && rest.compare(lower_) < 0) {
+    return kBelow;
+  }
+  if (!upper_successor_.empty() && rest.compare(upper_successor_) >= 0) {
+    return kAbove;
+  }
+  return kInRange;
+}
+
+}}  // namespace rocksdb::table
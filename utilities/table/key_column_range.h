@@ -0,0 +1,57 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "utilities/table/table_schema.h"
+
+namespace rocksdb { namespace table {
+
+// A range of values of the key column at leading.size(), checked on
+// encoded keys: lower <= column <= upper, with the leading columns
+// unconstrained. Only the leading columns are skipped to find the
+// column; nothing is decoded.
+//
+// The bounds are encoded column values, so a descending column's bounds
+// are swapped by the caller. An empty lower or upper bound is unbounded.
+class KeyColumnRange {
+ public:
+  enum Position {
+    // The key ends before the column.
+    kIncomplete,
+    kBelow,
+    kInRange,
+    kAbove,
+  };
+
+  KeyColumnRange() {}
+  KeyColumnRange(const std::vector<ColumnSpec>& leading,
+                 const std::string& lower, const std::string& upper);
+
+  // Where the column of key lies relative to the range. Unless the key is
+  // incomplete, *leading is set to the bytes of the leading columns.
+  Position Locate(const Slice& key, Slice* leading) const;
+
+  bool Matches(const Slice& key) const {
+    Slice leading;
+    return Locate(key, &leading) == kInRange;
+  }
+
+  const std::vector<ColumnSpec>& leading() const { return leading_; }
+  const std::string& lower() const { return lower_; }
+  // Empty if the range has no upper bound.
+  const std::string& upper_successor() const { return upper_successor_; }
+
+ private:
+  std::vector<ColumnSpec> leading_;
+  std::string lower_;
+  // PrefixSuccessor of the upper bound: the column is in range while the
+  // rest of the key sorts before it.
+  std::string upper_successor_;
+};
+
+}}  // namespace rocksdb::table
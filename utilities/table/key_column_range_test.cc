@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/key_column_range.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+const ColumnSpec kString = {Dynamic::T_STRING, false,
+                            ColumnEncoding::kDefault, 0};
+
+std::string Int(int64_t v) {
+  std::string encoded;
+  Serialize<int64_t>(v, encoded);
+  return encoded;
+}
+
+std::string DescInt(int64_t v) {
+  std::string encoded;
+  SerializeDescending<int64_t>(v, encoded);
+  return encoded;
+}
+
+std::string String(const std::string& s) {
+  std::string encoded;
+  Serialize<std::string>(s, encoded);
+  return encoded;
+}
+
+}  // namespace
+
+TEST(KeyColumnRange, Locate) {
+  KeyColumnRange range({kInt}, Int(10), Int(20));
+  const std::string leading = Int(7);
+  Slice found;
+
+  const std::string below = leading + Int(9);
+  EXPECT_EQ(KeyColumnRange::kBelow, range.Locate(below, &found));
+  EXPECT_EQ(leading, found.ToString());
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + Int(10), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + Int(20) + String("rest"), &found));
+  const std::string above = leading + Int(21);
+  EXPECT_EQ(KeyColumnRange::kAbove, range.Locate(above, &found));
+  EXPECT_EQ(leading, found.ToString());
+
+  EXPECT_TRUE(range.Matches(leading + Int(15)));
+  EXPECT_FALSE(range.Matches(leading + Int(-15)));
+}
+
+TEST(KeyColumnRange, Incomplete) {
+  KeyColumnRange range({kString, kInt}, Int(10), Int(20));
+  const std::string leading = String("a") + Int(1);
+  Slice found("unchanged");
+  EXPECT_EQ(KeyColumnRange::kIncomplete, range.Locate("", &found));
+  EXPECT_EQ(KeyColumnRange::kIncomplete,
+            range.Locate(String("a"), &found));
+  EXPECT_EQ(KeyColumnRange::kIncomplete,
+            range.Locate(Slice(leading.data(), leading.size() - 1), &found));
+  // The leading columns end where the key does.
+  EXPECT_EQ(KeyColumnRange::kIncomplete, range.Locate(leading, &found));
+  EXPECT_EQ("unchanged", found.ToString());
+  const std::string in_range = leading + Int(12);
+  EXPECT_EQ(KeyColumnRange::kInRange, range.Locate(in_range, &found));
+  EXPECT_EQ(leading, found.ToString());
+}
+
+TEST(KeyColumnRange, Unbounded) {
+  KeyColumnRange all({}, "", "");
+  Slice found;
+  EXPECT_EQ(KeyColumnRange::kInRange, all.Locate(Int(-100), &found));
+  EXPECT_TRUE(all.upper_successor().empty());
+
+  KeyColumnRange at_least({}, Int(5), "");
+  EXPECT_EQ(KeyColumnRange::kBelow, at_least.Locate(Int(4), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            at_least.Locate(Int(1 << 30), &found));
+
+  KeyColumnRange at_most({}, "", Int(5));
+  EXPECT_EQ(KeyColumnRange::kInRange, at_most.Locate(Int(-4), &found));
+  EXPECT_EQ(KeyColumnRange::kAbove, at_most.Locate(Int(6), &found));
+}
+
+TEST(KeyColumnRange, DescendingBounds) {
+  // The caller swaps the bounds of a descending column: values from 10
+  // to 20 are the encodings from 20 to 10.
+  KeyColumnRange range({kInt}, DescInt(20), DescInt(10));
+  const std::string leading = Int(1);
+  Slice found;
+  EXPECT_EQ(KeyColumnRange::kBelow,
+            range.Locate(leading + DescInt(21), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + DescInt(20), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + DescInt(10), &found));
+  EXPECT_EQ(KeyColumnRange::kAbove,
+            range.Locate(leading + DescInt(9), &found));
+}
+
+TEST(KeyColumnRange, StringUpperBoundIsInclusive) {
+  KeyColumnRange range({kInt}, String("b"), String("c"));
+  const std::string leading = Int(1);
+  Slice found;
+  EXPECT_EQ(KeyColumnRange::kBelow,
+            range.Locate(leading + String("az"), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + String("b"), &found));
+  EXPECT_EQ(KeyColumnRange::kInRange,
+            range.Locate(leading + String("c") + Int(3), &found));
+  EXPECT_EQ(KeyColumnRange::kAbove,
+            range.Locate(leading + String("ca"), &found));
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,7 +15,9 @@ namespace rocksdb { namespace table {
 void LDBTool::Run(int argc, char** argv, rocksdb::Options options,
                   const rocksdb::LDBOptions& ldb_options,
                   const std::vector<ColumnFamilyDescriptor>* column_families) {
-  options.comparator = rocksdb::ReverseBytewiseComparator();
+  // Tables use the default bytewise comparator; descending columns are
+  // inverted by the encoding instead. --order=desc selects
+  // ReverseBytewiseComparator for older DBs.
   rocksdb::LDBOptions ldbOptions = ldb_options;
   rocksdb::table::LDBCommandRunner::RunCommand(argc, argv, options, ldbOptions,
                                                column_families);
@@ -6,10 +6,30 @@
 #ifndef ROCKSDB_LITE
 #include "utilities/table/ldb_table_cmd.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <rocksdb/comparator.h>
+#include <rocksdb/env.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/metadata.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/table.h>
+
+#include "utilities/table/column_prefix_transform.h"
+#include "utilities/table/multi_get.h"
+#include "utilities/table/skip_scan_iterator.h"
+#include "utilities/table/sorted_run.h"
+#include "utilities/table/ttl_compaction_filter.h"
+#include "utilities/table/zone_map_collector.h"
 
 namespace rocksdb { namespace table {
 
@@ -18,6 +38,76 @@ using namespace std;
 
 const string LDBCommand::ARG_ORDER = "order";
 const string LDBCommand::ARG_SCHEMA = "schema";
+const string LDBCommand::ARG_THREADS = "threads";
+const string LDBCommand::ARG_BULK_LOAD = "bulk_load";
+const string LDBCommand::ARG_BATCH_SIZE = "batch_size";
+const string LDBCommand::ARG_BATCH_BYTES = "batch_bytes";
+const string LDBCommand::ARG_DISABLE_WAL = "disable_wal";
+const string LDBCommand::ARG_INPUT = "input";
+const string LDBCommand::ARG_SCHEMA_ID_COLUMN = "schema_id_column";
+const string LDBCommand::ARG_PREFIX_COLUMNS = "prefix_columns";
+const string LDBCommand::ARG_PREFIX = "prefix";
+const string LDBCommand::ARG_REVERSE = "reverse";
+const string LDBCommand::ARG_SKIP_SCAN_COLUMN = "skip_scan_column";
+const string LDBCommand::ARG_SKIP_SCAN_FROM = "skip_scan_from";
+const string LDBCommand::ARG_SKIP_SCAN_TO = "skip_scan_to";
+const string LDBCommand::ARG_WHERE_COLUMN = "where_column";
+const string LDBCommand::ARG_WHERE_FROM = "where_from";
+const string LDBCommand::ARG_WHERE_TO = "where_to";
+const string LDBCommand::ARG_OUTPUT_PREFIX = "output_prefix";
+const string LDBCommand::ARG_OUTPUT = "output";
+const string LDBCommand::ARG_INDEX_LOOKUP = "index_lookup";
+const string LDBCommand::ARG_PLAIN_TABLE = "plain_table";
+
+// Encoded bytes a bulk load worker buffers before spilling a sorted run,
+// and the size at which the merged rows are cut into SST files.
+static const size_t kBulkLoadFileSize = 64 << 20;
+
+namespace {
+
+// Rows and bytes loaded by tload, reported about once a second.
+class LoadProgress {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  LoadProgress()
+    : start_(Clock::now()), last_report_(start_), rows_(0), bytes_(0) {}
+
+  void Add(size_t rows, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rows_ += rows;
+    bytes_ += bytes;
+    auto now = Clock::now();
+    if (now - last_report_ >= std::chrono::seconds(1)) {
+      last_report_ = now;
+      Report(now);
+    }
+  }
+
+  void Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Report(Clock::now());
+  }
+
+ private:
+  void Report(Clock::time_point now) const {
+    double secs = std::chrono::duration<double>(now - start_).count();
+    if (secs <= 0) {
+      secs = 1e-9;
+    }
+    fprintf(stdout, "%zu rows, %.0f rows/s, %.1f MB/s\n", rows_,
+            rows_ / secs, bytes_ / secs / (1 << 20));
+    fflush(stdout);
+  }
+
+  const Clock::time_point start_;
+  Clock::time_point last_report_;
+  size_t rows_;
+  size_t bytes_;
+  std::mutex mutex_;
+};
+
+}  // namespace
 
 LDBCommand::LDBCommand(const map<string, string>& options,
                        const vector<string>& flags,
@@ -25,28 +115,278 @@ LDBCommand::LDBCommand(const map<string, string>& options,
                        const vector<string>& valid_cmd_line_options) :
   rocksdb::LDBCommand(options, flags, is_read_only, valid_cmd_line_options) {
   map<string, string>::const_iterator itr = options.find(ARG_ORDER);
-  descending_ = true;
+  descending_ = false;
   if (itr != options.end()) {
-    if (itr->second == "asc") {
-      descending_ = false;
+    if (itr->second == "desc") {
+      descending_ = true;
     }
   }
   itr = options.find(ARG_SCHEMA);
   if (itr != options.end()) {
     schema_path_ = itr->second;
   }
+  int schema_id_column = 0;
+  if (ParseIntOption(options, ARG_SCHEMA_ID_COLUMN, schema_id_column,
+                     exec_state_)) {
+    if (schema_id_column < 0) {
+      exec_state_ = LDBCommandExecuteResult::Failed(
+          ARG_SCHEMA_ID_COLUMN + " must not be negative");
+    } else {
+      schemas_ = SchemaRegistry(schema_id_column);
+    }
+  }
+  prefix_columns_ = -1;
+  if (ParseIntOption(options, ARG_PREFIX_COLUMNS, prefix_columns_,
+                     exec_state_) && prefix_columns_ < 0) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        ARG_PREFIX_COLUMNS + " must not be negative");
+  }
+  plain_table_ = IsFlagPresent(flags, ARG_PLAIN_TABLE);
+}
+
+Options LDBCommand::PrepareOptionsForOpenDB() {
+  Options opt = rocksdb::LDBCommand::PrepareOptionsForOpenDB();
+  if (schemas_.has_ttl()) {
+    opt.compaction_filter_factory =
+        std::make_shared<TtlCompactionFilterFactory>(schemas_);
+  }
+  if (schemas_.has_zone_maps()) {
+    opt.table_properties_collector_factories.push_back(
+        std::make_shared<ZoneMapCollectorFactory>(schemas_));
+  }
+  if (plain_table_) {
+    UsePlainTable(&opt);
+    return opt;
+  }
+  size_t n = prefix_columns_;
+  if (prefix_columns_ < 0) {
+    if (schemas_.empty()) {
+      return opt;
+    }
+    n = schemas_.schema_id_column() + 1;
+  }
+  if (n == 0) {
+    return opt;
+  }
+  std::vector<ColumnSpec> columns;
+  Status st = schemas_.KeyPrefix(n, &columns);
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_PREFIX_COLUMNS + ": " +
+                                                  st.ToString());
+    return opt;
+  }
+  opt.prefix_extractor.reset(new ColumnPrefixTransform(columns));
+  opt.memtable_prefix_bloom_size_ratio = 0.1;
+  // Keep whole key filtering, so point lookups still skip files. The
+  // table options of --bloom_bits and --block_size are kept; without a
+  // filter from --bloom_bits, a 10 bit one is added.
+  BlockBasedTableOptions table_options;
+  if (opt.table_factory != nullptr &&
+      strcmp(opt.table_factory->Name(), "BlockBasedTable") == 0) {
+    table_options = *static_cast<BlockBasedTableOptions*>(
+        opt.table_factory->GetOptions());
+  }
+  if (table_options.filter_policy == nullptr) {
+    table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+    opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  }
+  return opt;
+}
+
+// PlainTable keeps fixed length keys in mmapped files, without block
+// reads or decompression, and stores no key length per row. By default
+// it is opened in total order mode, finding keys by binary search over
+// a sparse in-memory index, since tscan seeks across prefixes. With
+// --prefix_columns it builds a hash index on the prefix instead, for
+// point lookups with tget, and only prefix seeks are supported. The
+// bloom filter is over whole keys or prefixes accordingly.
+void LDBCommand::UsePlainTable(Options* opt) {
+  size_t key_length = schemas_.FixedKeyLength();
+  if (key_length == 0) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        ARG_PLAIN_TABLE + " needs keys of one fixed length in every schema; "
+        "use fixed width numeric, bool and char(N) key columns");
+    return;
+  }
+  PlainTableOptions table_options;
+  table_options.user_key_len = static_cast<uint32_t>(key_length);
+  table_options.bloom_bits_per_key = 10;
+  table_options.hash_table_ratio = 0;
+  if (prefix_columns_ > 0) {
+    std::vector<ColumnSpec> columns;
+    Status st = schemas_.KeyPrefix(prefix_columns_, &columns);
+    if (!st.ok()) {
+      exec_state_ = LDBCommandExecuteResult::Failed(
+          ARG_PREFIX_COLUMNS + ": " + st.ToString());
+      return;
+    }
+    opt->prefix_extractor.reset(new ColumnPrefixTransform(columns));
+    table_options.hash_table_ratio = 0.75;
+  }
+  opt->table_factory.reset(NewPlainTableFactory(table_options));
+  opt->allow_mmap_reads = true;
+}
+
+// Dictionaries are kept next to the DB files, as DICTIONARY-<name>.
+Status LDBCommand::OpenDictionary(
+    const std::string& name, std::shared_ptr<StringDictionary>* dictionary) {
+  auto it = dictionaries_.find(name);
+  if (it != dictionaries_.end()) {
+    *dictionary = it->second;
+    return Status::OK();
+  }
+  for (char c : name) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      return Status::InvalidArgument("bad dictionary name", name);
+    }
+  }
+  dictionary->reset(new StringDictionary(name));
+  Status st = (*dictionary)->Load(Env::Default(),
+                                  db_path_ + "/DICTIONARY-" + name);
+  if (st.ok()) {
+    dictionaries_[name] = *dictionary;
+  }
+  return st;
+}
+
+Status LDBCommand::SaveDictionaries() {
+  for (const auto& entry : dictionaries_) {
+    Status st = entry.second->Save(Env::Default(),
+                                   db_path_ + "/DICTIONARY-" + entry.first);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return Status::OK();
 }
 
 // Please keep this in-sync with Dynamic.h
-static std::map<std::string, rocksdb::Dynamic::Type> typeNameMap = {
-  { "blank", rocksdb::Dynamic::T_BLANK},
-  { "bool", rocksdb::Dynamic::T_BOOL},
-  { "double", rocksdb::Dynamic::T_DOUBLE},
-  { "int", rocksdb::Dynamic::T_INT},
-  { "string", rocksdb::Dynamic::T_STRING},
-  { "slice", rocksdb::Dynamic::T_SLICE},
+static std::map<std::string, ColumnSpec> typeNameMap = {
+  { "blank",
+    {rocksdb::Dynamic::T_BLANK, false, ColumnEncoding::kDefault, 0}},
+  { "bool",
+    {rocksdb::Dynamic::T_BOOL, false, ColumnEncoding::kDefault, 0}},
+  { "double",
+    {rocksdb::Dynamic::T_DOUBLE, false, ColumnEncoding::kDefault, 0}},
+  { "int",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kDefault, 0}},
+  { "varint",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kVarint, 0}},
+  { "string",
+    {rocksdb::Dynamic::T_STRING, false, ColumnEncoding::kDefault, 0}},
+  { "slice",
+    {rocksdb::Dynamic::T_SLICE, false, ColumnEncoding::kDefault, 0}},
+  { "int8",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kInt8, 0}},
+  { "int16",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kInt16, 0}},
+  { "int32",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kInt32, 0}},
+  { "uint8",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kUInt8, 0}},
+  { "uint16",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kUInt16, 0}},
+  { "uint32",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kUInt32, 0}},
+  { "uint64",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kUInt64, 0}},
+  { "float",
+    {rocksdb::Dynamic::T_DOUBLE, false, ColumnEncoding::kFloat, 0}},
+  { "timestamp",
+    {rocksdb::Dynamic::T_INT, false, ColumnEncoding::kTimestamp, 0}},
 };
 
+// A name of typeNameMap, or "char(<N>)" for a string padded to N bytes.
+static bool ParseTypeName(const std::string& name, ColumnSpec* spec) {
+  auto it = typeNameMap.find(name);
+  if (it != typeNameMap.end()) {
+    *spec = it->second;
+    return true;
+  }
+  int64_t width;
+  if (name.size() < 7 || name.compare(0, 5, "char(") != 0 ||
+      name.back() != ')' ||
+      !ParseInt64(Slice(name.data() + 5, name.size() - 6), &width) ||
+      width <= 0 || width > std::numeric_limits<uint16_t>::max()) {
+    return false;
+  }
+  *spec = {rocksdb::Dynamic::T_STRING, false, ColumnEncoding::kFixed,
+           static_cast<uint32_t>(width)};
+  return true;
+}
+
+// Parse "<index id>:<columns>", where columns is a comma separated
+// list of key column numbers and value column numbers prefixed by v,
+// e.g. "10:v0,2".
+static bool ParseIndex(const Slice& text, IndexSpec* index) {
+  const char* colon = static_cast<const char*>(
+      memchr(text.data(), ':', text.size()));
+  if (colon == nullptr ||
+      !ParseInt64(Slice(text.data(), colon - text.data()), &index->id)) {
+    return false;
+  }
+  Slice rest(colon + 1, text.data() + text.size() - colon - 1);
+  while (!rest.empty()) {
+    const char* comma = static_cast<const char*>(
+        memchr(rest.data(), ',', rest.size()));
+    size_t len = comma == nullptr ? rest.size() : comma - rest.data();
+    Slice column(rest.data(), len);
+    rest.remove_prefix(comma == nullptr ? len : len + 1);
+    ColumnRef ref = {false, 0};
+    if (column.starts_with("v")) {
+      ref.value = true;
+      column.remove_prefix(1);
+    }
+    int64_t n;
+    if (!ParseInt64(column, &n) || n < 0 ||
+        n > std::numeric_limits<int>::max()) {
+      return false;
+    }
+    ref.n = static_cast<int>(n);
+    index->columns.push_back(ref);
+  }
+  return !index->columns.empty();
+}
+
+// Schema file format, one schema per line:
+//
+//   <schema id> <key types> ==> <value types>
+//
+// A type may be followed by "desc" to sort that key column in descending
+// order, e.g. "1 int int desc ==> string". The schema id column itself
+// must stay ascending. Each schema is compiled into a SchemaRegistry
+// decoding plan as it is read.
+//
+// The types are the names in typeNameMap, and dict(<name>) and
+// char(<N>) below. int and double take 8 bytes; int8 to int32, uint8 to
+// uint64 and float are narrower or unsigned, and timestamp is an int of
+// microseconds since the epoch.
+//
+// A line may end with settings: "ttl_column=<N> retention=<seconds>"
+// expires rows once int key column N, a time in seconds since the epoch
+// or a timestamp in microseconds, is more than retention seconds old,
+// e.g.
+//
+//   3 int int ==> string ttl_column=1 retention=86400
+//
+// "zone_map=<N>", which may be repeated, records the min and max of key
+// column N in every SST file so that scans with a range on the column
+// skip files outside of it; see ZoneMapCollector.
+//
+// "dict(<name>)" is a string column stored as its code in the order
+// preserving dictionary called name, e.g. "dict(country)"; columns that
+// name the same dictionary share its codes. See StringDictionary.
+//
+// "char(<N>)" is a string column stored in exactly N bytes, padded with
+// NULs, so that keys of fixed width numeric, bool and char(N) columns
+// all have the same length; see --plain_table. Values longer than N, or
+// ending in a NUL that the padding would hide, are rejected.
+//
+// "index=<id>:<columns>" adds a secondary index on key columns and value
+// columns prefixed by v, e.g. "index=10:v0" on the first value column.
+// tput and tload write its entries in the batch of the row, and
+// "tscan --index_lookup --prefix=<id> <values>" reads the rows through
+// it; see IndexSpec.
 void LDBCommand::ParseSchemaFile() {
   std::ifstream schema_file(schema_path_);
   std::string line;
@@ -59,11 +399,11 @@ void LDBCommand::ParseSchemaFile() {
       has_complete_line = false;
     }
     int64_t schema;
-    std::vector<rocksdb::Dynamic> kvec;
-    std::vector<rocksdb::Dynamic> vvec;
+    TableSchema table_schema;
     if (has_complete_line) {
       std::stringstream ss(line);
       std::string type_name;
+      int64_t ttl_column = -1;
       ss >> schema;
       std::string delim = DELIM;
       delim = delim.substr(1, delim.size() - 2);
@@ -72,59 +412,265 @@ void LDBCommand::ParseSchemaFile() {
           seen_delim = true;
           continue;
         }
-        auto typeEnum = typeNameMap.at(type_name);
-        if (seen_delim) {
-          vvec.emplace_back(Dynamic(typeEnum));
-        } else {
-          kvec.emplace_back(Dynamic(typeEnum));
+        auto& columns = seen_delim ? table_schema.value : table_schema.key;
+        if (type_name == "desc" || type_name == "asc") {
+          if (columns.empty()) {
+            exec_state_ = LDBCommandExecuteResult::Failed(
+                type_name + " must follow a column type in schema " +
+                std::to_string(schema));
+            return;
+          }
+          columns.back().descending = type_name == "desc";
+          continue;
+        }
+        size_t eq = type_name.find('=');
+        if (eq != std::string::npos) {
+          std::string name = type_name.substr(0, eq);
+          Slice text(type_name.data() + eq + 1, type_name.size() - eq - 1);
+          int64_t setting;
+          bool ok = ParseInt64(text, &setting);
+          IndexSpec index;
+          if (name == "index" && ParseIndex(text, &index)) {
+            table_schema.indexes.push_back(index);
+          } else if (ok && name == "ttl_column") {
+            ttl_column = setting;
+          } else if (ok && name == "retention") {
+            table_schema.retention = setting;
+          } else if (ok && name == "zone_map") {
+            table_schema.zone_map_columns.push_back(
+                static_cast<int>(setting));
+          } else {
+            exec_state_ = LDBCommandExecuteResult::Failed(
+                "bad setting " + type_name + " in schema " +
+                std::to_string(schema));
+            return;
+          }
+          continue;
+        }
+        ColumnSpec spec;
+        if (type_name.compare(0, 5, "dict(") == 0 &&
+            type_name.size() > 6 && type_name.back() == ')') {
+          spec = {rocksdb::Dynamic::T_STRING, false,
+                  ColumnEncoding::kDictionary, 0};
+          Status st = OpenDictionary(
+              type_name.substr(5, type_name.size() - 6), &spec.dictionary);
+          if (!st.ok()) {
+            exec_state_ = LDBCommandExecuteResult::Failed(
+                "schema " + std::to_string(schema) + ": " + st.ToString());
+            return;
+          }
+        } else if (!ParseTypeName(type_name, &spec)) {
+          exec_state_ = LDBCommandExecuteResult::Failed(
+              "unknown type " + type_name + " in schema " +
+              std::to_string(schema));
+          return;
         }
+        columns.push_back(spec);
+      }
+      table_schema.ttl_column = static_cast<int>(ttl_column);
+      Status st = schemas_.Add(schema, table_schema);
+      if (!st.ok()) {
+        exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+        return;
       }
-      schema_[schema] = {std::move(kvec), std::move(vvec)};
     } else {
       break;
     }
   }
 }
 
-void LDBCommand::ParseKeyValue(std::vector<Dynamic>& key,
-                               std::vector<Dynamic>& val,
-                               const vector<string>& params) {
-  std::string delim = DELIM;
-  delim = delim.substr(1, delim.size() - 2);
-  auto sep = std::find(params.begin(), params.end(), delim);
-  auto kIt = params.begin();
-  for (; kIt != sep; kIt++) {
-    if (kIt->at(0) == '"') {
-      const auto& str = kIt->substr(1, kIt->size() - 2);
-      key.emplace_back(str);
+Status LDBCommand::EncodeKeyPrefix(const std::string& text,
+                                   std::string* out) const {
+  std::vector<Slice> tokens;
+  SplitTokens(text, &tokens);
+  std::vector<ColumnSpec> specs;
+  size_t id_column = schemas_.schema_id_column();
+  int64_t schema_id;
+  const CompiledSchema* compiled = nullptr;
+  if (tokens.size() > id_column &&
+      ParseInt64(tokens[id_column], &schema_id)) {
+    compiled = schemas_.Find(schema_id);
+  }
+  if (compiled != nullptr) {
+    if (tokens.size() > compiled->schema.key.size()) {
+      return Status::InvalidArgument(
+          "more columns than the key of schema " + std::to_string(schema_id),
+          text);
+    }
+    specs = compiled->schema.key;
+  } else if (schemas_.empty() ||
+             !schemas_.KeyPrefix(tokens.size(), &specs).ok()) {
+    specs.clear();
+    for (const auto& token : tokens) {
+      specs.push_back(TokenSpec(token));
+    }
+  }
+  Status st;
+  for (size_t i = 0; st.ok() && i < tokens.size(); i++) {
+    st = EncodeLookupToken(specs[i], tokens[i], out);
+  }
+  return st;
+}
+
+Status LDBCommand::ParseKeyRange(const map<string, string>& options,
+                                 std::string* begin, bool* has_begin,
+                                 std::string* end, bool* has_end) const {
+  *has_begin = false;
+  *has_end = false;
+  Status st;
+  auto itr = options.find(ARG_FROM);
+  if (st.ok() && itr != options.end()) {
+    if (is_key_hex_) {
+      *begin = HexToString(itr->second);
     } else {
-      // Assumed to be an int
-      key.emplace_back(std::atoi(kIt->c_str()));
+      st = EncodeKeyPrefix(itr->second, begin);
     }
+    *has_begin = true;
   }
-  kIt++;  // skip over sep
-  for (auto vIt = kIt; vIt != params.end(); vIt++) {
-    if (vIt->at(0) == '"') {
-      const auto& str = vIt->substr(1, vIt->size() - 2);
-      val.emplace_back(str);
+  itr = options.find(ARG_TO);
+  if (st.ok() && itr != options.end()) {
+    if (is_key_hex_) {
+      *end = HexToString(itr->second);
     } else {
-      // Assumed to be an int
-      val.emplace_back(std::atoi(vIt->c_str()));
+      st = EncodeKeyPrefix(itr->second, end);
+    }
+    *has_end = true;
+  }
+  itr = options.find(ARG_PREFIX);
+  if (st.ok() && itr != options.end()) {
+    if (*has_begin || *has_end) {
+      return Status::InvalidArgument(ARG_PREFIX + " can't be combined with " +
+                                     ARG_FROM + " or " + ARG_TO);
+    }
+    if (descending_) {
+      // Keys with the prefix don't end at its successor under
+      // ReverseBytewiseComparator.
+      return Status::NotSupported(ARG_PREFIX + " with " + ARG_ORDER +
+                                  "=desc");
+    }
+    if (is_key_hex_) {
+      *begin = HexToString(itr->second);
+    } else {
+      st = EncodeKeyPrefix(itr->second, begin);
+    }
+    *has_begin = true;
+    *end = PrefixSuccessor(*begin);
+    *has_end = !end->empty();
+  }
+  return st;
+}
+
+Status LDBCommand::ParseColumnRange(const map<string, string>& options,
+                                    const std::string& column_arg,
+                                    const std::string& from_arg,
+                                    const std::string& to_arg, int* column,
+                                    KeyColumnRange* range) const {
+  *column = -1;
+  auto itr = options.find(column_arg);
+  if (itr == options.end()) {
+    if (options.count(from_arg) || options.count(to_arg)) {
+      return Status::InvalidArgument(column_arg + " is required");
+    }
+    return Status::OK();
+  }
+  int64_t n;
+  if (!ParseInt64(itr->second, &n) || n < 0) {
+    return Status::InvalidArgument(column_arg, itr->second);
+  }
+  if (descending_) {
+    return Status::NotSupported(column_arg + " with " + ARG_ORDER + "=desc");
+  }
+  std::vector<ColumnSpec> columns;
+  Status st = schemas_.KeyPrefix(n + 1, &columns);
+  if (!st.ok()) {
+    return st;
+  }
+  const ColumnSpec spec = columns.back();
+  columns.pop_back();
+  std::string lower;
+  std::string upper;
+  itr = options.find(from_arg);
+  if (st.ok() && itr != options.end()) {
+    st = EncodeLookupToken(spec, itr->second, &lower);
+  }
+  itr = options.find(to_arg);
+  if (st.ok() && itr != options.end()) {
+    st = EncodeLookupToken(spec, itr->second, &upper);
+  }
+  if (spec.descending) {
+    // The encoding of a descending column sorts in reverse.
+    std::swap(lower, upper);
+  }
+  *range = KeyColumnRange(columns, lower, upper);
+  *column = static_cast<int>(n);
+  return st;
+}
+
+Status LDBCommand::EncodeLine(const Slice& line, std::vector<Slice>* tokens,
+                              std::string* encoded_key,
+                              std::string* encoded_val) const {
+  tokens->clear();
+  SplitTokens(line, tokens);
+  return EncodeTokens(*tokens, encoded_key, encoded_val);
+}
+
+Status LDBCommand::EncodeTokens(const std::vector<Slice>& tokens,
+                                std::string* encoded_key,
+                                std::string* encoded_val) const {
+  static const std::string delim =
+    std::string(DELIM).substr(1, std::string(DELIM).size() - 2);
+  auto sep = std::find(tokens.begin(), tokens.end(), Slice(delim));
+  if (sep == tokens.end()) {
+    return Status::InvalidArgument("missing " + delim);
+  }
+  size_t num_key = sep - tokens.begin();
+  size_t num_val = tokens.end() - sep - 1;
+  const TableSchema* schema = nullptr;
+  if (!schemas_.empty()) {
+    size_t id_column = schemas_.schema_id_column();
+    int64_t schema_id;
+    if (num_key <= id_column || !ParseInt64(tokens[id_column], &schema_id)) {
+      return Status::InvalidArgument(
+          "no schema id in key column " + std::to_string(id_column));
+    }
+    const CompiledSchema* compiled = schemas_.Find(schema_id);
+    if (compiled == nullptr) {
+      return Status::InvalidArgument("unknown schema id",
+                                     tokens[id_column]);
+    }
+    schema = &compiled->schema;
+    if (schema->key.size() != num_key || schema->value.size() != num_val) {
+      return Status::InvalidArgument(
+          "schema " + std::to_string(schema_id) + " has " +
+          std::to_string(schema->key.size()) + " key and " +
+          std::to_string(schema->value.size()) + " value columns");
     }
   }
+  Status st;
+  for (size_t i = 0; st.ok() && i < num_key; i++) {
+    const Slice& token = tokens[i];
+    st = EncodeToken(schema ? schema->key[i] : TokenSpec(token), token,
+                     encoded_key);
+  }
+  for (size_t i = 0; st.ok() && i < num_val; i++) {
+    const Slice& token = tokens[num_key + 1 + i];
+    st = EncodeToken(schema ? schema->value[i] : TokenSpec(token), token,
+                     encoded_val);
+  }
+  return st;
 }
 
 TPutCommand::TPutCommand(const vector<string>& params,
       const map<string, string>& options, const vector<string>& flags) :
   LDBCommand(options, flags, false,
              BuildCmdLineOptions({ARG_CREATE_IF_MISSING, ARG_ORDER,
-                                  ARG_SCHEMA})) {
+                                  ARG_SCHEMA, ARG_SCHEMA_ID_COLUMN,
+                                  ARG_PREFIX_COLUMNS, ARG_PLAIN_TABLE})) {
   if (params.size() < 2) {
     exec_state_ = LDBCommandExecuteResult::Failed(
         "<key> and <value> must be specified for the put command");
-  } else {
-    ParseKeyValue(key_, value_, params);
   }
+  row_ = params;
   ParseSchemaFile();
 }
 
@@ -134,13 +680,37 @@ void TPutCommand::Help(string& ret) {
   ret.append("<keys> ==> <values> ");
   ret.append(" [--" + ARG_TTL + "]");
   ret.append(" [--" + ARG_SCHEMA + "]");
-  ret.append(" [--" + ARG_ORDER + "]");
+  ret.append(" [--" + ARG_SCHEMA_ID_COLUMN + "=<N>]");
+  ret.append(" [--" + ARG_PREFIX_COLUMNS + "=<N>]");
+  ret.append(" [--" + ARG_PLAIN_TABLE + "]");
+  ret.append(" [--" + ARG_ORDER + "=desc]");
   ret.append("\n");
   ret.append("Strings should be enclosed in double quotes\n");
 }
 
 void TPutCommand::DoCommand() {
-  Status st = TableInterface::Put(db_, WriteOptions(), key_, value_);
+  std::string key;
+  std::string value;
+  // The arguments are already split into tokens, so a quoted string may
+  // contain spaces.
+  std::vector<Slice> tokens(row_.begin(), row_.end());
+  Status st = EncodeTokens(tokens, &key, &value);
+  // The index entries are written atomically with the row.
+  WriteBatch batch;
+  batch.Put(key, value);
+  std::vector<std::string> index_keys;
+  if (st.ok()) {
+    st = schemas_.IndexKeys(key, value, &index_keys);
+  }
+  for (const auto& index_key : index_keys) {
+    batch.Put(index_key, Slice());
+  }
+  if (st.ok()) {
+    st = SaveDictionaries();
+  }
+  if (st.ok()) {
+    st = db_->Write(WriteOptions(), &batch);
+  }
   if (st.ok()) {
     fprintf(stdout, "OK\n");
   } else {
@@ -150,8 +720,8 @@ void TPutCommand::DoCommand() {
 
 Options TPutCommand::PrepareOptionsForOpenDB() {
   Options opt = LDBCommand::PrepareOptionsForOpenDB();
-  if (!descending_) {
-    opt.comparator = rocksdb::BytewiseComparator();
+  if (descending_) {
+    opt.comparator = rocksdb::ReverseBytewiseComparator();
   }
   opt.create_if_missing = IsFlagPresent(flags_, ARG_CREATE_IF_MISSING);
   return opt;
@@ -160,29 +730,28 @@ Options TPutCommand::PrepareOptionsForOpenDB() {
 TScanCommand::TScanCommand(const vector<string>& params,
       const map<string, string>& options, const vector<string>& flags) :
     LDBCommand(options, flags, true,
-               BuildCmdLineOptions({ARG_TO, ARG_FROM, ARG_TIMESTAMP,
-                                    ARG_MAX_KEYS, ARG_ORDER, ARG_SCHEMA})),
+               BuildCmdLineOptions({ARG_TO, ARG_FROM, ARG_PREFIX,
+                                    ARG_TIMESTAMP, ARG_MAX_KEYS, ARG_ORDER,
+                                    ARG_SCHEMA, ARG_SCHEMA_ID_COLUMN,
+                                    ARG_PREFIX_COLUMNS, ARG_PLAIN_TABLE,
+                                    ARG_REVERSE,
+                                    ARG_SKIP_SCAN_COLUMN, ARG_SKIP_SCAN_FROM,
+                                    ARG_SKIP_SCAN_TO, ARG_THREADS,
+                                    ARG_OUTPUT_PREFIX, ARG_OUTPUT,
+                                    ARG_INDEX_LOOKUP, ARG_BATCH_SIZE})),
     start_key_specified_(false),
     end_key_specified_(false),
-    max_keys_scanned_(-1) {
-  map<string, string>::const_iterator itr = options.find(ARG_FROM);
-  if (itr != options.end()) {
-    start_key_ = itr->second;
-    if (is_key_hex_) {
-      start_key_ = HexToString(start_key_);
-    }
-    start_key_specified_ = true;
-  }
-  itr = options.find(ARG_TO);
-  if (itr != options.end()) {
-    end_key_ = itr->second;
-    if (is_key_hex_) {
-      end_key_ = HexToString(end_key_);
-    }
-    end_key_specified_ = true;
-  }
-
-  itr = options.find(ARG_MAX_KEYS);
+    max_keys_scanned_(-1),
+    reverse_(IsFlagPresent(flags, ARG_REVERSE)),
+    skip_scan_column_(-1),
+    threads_(1),
+    output_format_("text"),
+    index_lookup_(IsFlagPresent(flags, ARG_INDEX_LOOKUP)),
+    batch_size_(64),
+    stale_index_entries_(0),
+    seeks_(0),
+    files_skipped_(0) {
+  map<string, string>::const_iterator itr = options.find(ARG_MAX_KEYS);
   if (itr != options.end()) {
     try {
 #if defined(CYGWIN)
@@ -198,69 +767,654 @@ TScanCommand::TScanCommand(const vector<string>& params,
           ARG_MAX_KEYS + " has a value out-of-range");
     }
   }
+  if (ParseIntOption(options, ARG_THREADS, threads_, exec_state_) &&
+      threads_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_THREADS +
+                                                  " must be at least 1");
+  }
+  if (ParseIntOption(options, ARG_BATCH_SIZE, batch_size_, exec_state_) &&
+      batch_size_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_BATCH_SIZE +
+                                                  " must be at least 1");
+  }
+  itr = options.find(ARG_OUTPUT_PREFIX);
+  if (itr != options.end()) {
+    output_prefix_ = itr->second;
+  }
+  itr = options.find(ARG_OUTPUT);
+  if (itr != options.end()) {
+    output_format_ = itr->second;
+  }
   ParseSchemaFile();
+
+  // Typed bounds are encoded with the schemas, so they are parsed last.
+  Status st = ParseKeyRange(options, &start_key_, &start_key_specified_,
+                            &end_key_, &end_key_specified_);
+  if (st.ok()) {
+    st = ParseColumnRange(options, ARG_SKIP_SCAN_COLUMN, ARG_SKIP_SCAN_FROM,
+                          ARG_SKIP_SCAN_TO, &skip_scan_column_, &skip_scan_);
+  }
+  if (st.ok()) {
+    std::unique_ptr<RowFormatter> formatter;
+    st = NewRowFormatter(output_format_, &schemas_, &formatter);
+  }
+  if (st.ok() && reverse_ && skip_scan_column_ >= 0) {
+    st = Status::NotSupported(ARG_SKIP_SCAN_COLUMN + " with " + ARG_REVERSE);
+  }
+  if (st.ok() && (threads_ > 1 || !output_prefix_.empty()) &&
+      (reverse_ || max_keys_scanned_ >= 0 || index_lookup_)) {
+    st = Status::NotSupported(ARG_REVERSE + ", " + ARG_MAX_KEYS + " and " +
+                              ARG_INDEX_LOOKUP + " with " + ARG_THREADS +
+                              " or " + ARG_OUTPUT_PREFIX);
+  }
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
 }
 
 void TScanCommand::Help(string& ret) {
   ret.append("  ");
   ret.append(TScanCommand::Name());
   ret.append(HelpRangeCmdArgs());
+  ret.append(" [--" + ARG_PREFIX + "=<key columns>]");
+  ret.append(" [--" + ARG_REVERSE + "]");
+  ret.append(" [--" + ARG_SKIP_SCAN_COLUMN + "=<N>");
+  ret.append(" [--" + ARG_SKIP_SCAN_FROM + "=<value>]");
+  ret.append(" [--" + ARG_SKIP_SCAN_TO + "=<value>]]");
   ret.append(" [--" + ARG_TIMESTAMP + "]");
-  ret.append(" [--" + ARG_ORDER + "]");
+  ret.append(" [--" + ARG_ORDER + "=desc]");
   ret.append(" [--" + ARG_SCHEMA + "]");
+  ret.append(" [--" + ARG_SCHEMA_ID_COLUMN + "=<N>]");
+  ret.append(" [--" + ARG_PREFIX_COLUMNS + "=<N>]");
+  ret.append(" [--" + ARG_PLAIN_TABLE + "]");
+  ret.append(" [--" + ARG_THREADS + "=<N>]");
+  ret.append(" [--" + ARG_OUTPUT_PREFIX + "=<path>]");
+  ret.append(" [--" + ARG_OUTPUT + "=text|binary|columnar]");
+  ret.append(" [--" + ARG_INDEX_LOOKUP + " [--" + ARG_BATCH_SIZE + "=<N>]]");
   ret.append(" [--" + ARG_MAX_KEYS + "=<N>q] ");
   ret.append("\n");
 }
 
-void TScanCommand::DoCommand() {
-
-  int num_keys_scanned = 0;
+ReadOptions TScanCommand::ScanOptions(const Slice* lower,
+                                      const Slice* upper) {
   ReadOptions read_options;
-
   read_options.pin_data = true;
+  // The scan crosses prefixes, so the prefix bloom filters must not be
+  // used to skip files.
+  read_options.total_order_seek = true;
+  // RocksDB stops at the bounds itself and skips files and blocks
+  // outside of them.
+  read_options.iterate_lower_bound = lower;
+  read_options.iterate_upper_bound = upper;
+  // Files whose zone maps are outside of the skip scan range aren't
+  // opened.
+  if (skip_scan_column_ >= 0) {
+    read_options.table_filter = [this](const TableProperties& properties) {
+      bool match = ZoneMapMayMatch(properties, skip_scan_);
+      files_skipped_ += match ? 0 : 1;
+      return match;
+    };
+  }
+  return read_options;
+}
+
+Iterator* TScanCommand::NewScanIterator(const ReadOptions& read_options) {
   Iterator* it = db_->NewIterator(read_options);
-  if (start_key_specified_) {
+  if (skip_scan_column_ >= 0) {
+    it = new SkipScanIterator(it, skip_scan_);
+  }
+  return it;
+}
+
+void TScanCommand::ReportSkipScan() const {
+  if (skip_scan_column_ >= 0) {
+    fprintf(stderr, "skip scan: %llu seeks, %llu files skipped\n",
+            (unsigned long long) seeks_.load(),
+            (unsigned long long) files_skipped_.load());
+  }
+}
+
+void TScanCommand::DoCommand() {
+  if (threads_ > 1 || !output_prefix_.empty()) {
+    ParallelScan();
+    return;
+  }
+
+  int num_keys_scanned = 0;
+  Slice lower_bound(start_key_);
+  Slice upper_bound(end_key_);
+  ReadOptions read_options =
+      ScanOptions(start_key_specified_ ? &lower_bound : nullptr,
+                  end_key_specified_ ? &upper_bound : nullptr);
+  Iterator* it = NewScanIterator(read_options);
+  if (reverse_) {
+    if (end_key_specified_) {
+      // The upper bound is exclusive.
+      it->SeekForPrev(upper_bound);
+      if (it->Valid() && it->key() == upper_bound) {
+        it->Prev();
+      }
+    } else {
+      it->SeekToLast();
+    }
+  } else if (start_key_specified_) {
     it->Seek(start_key_);
   } else {
     it->SeekToFirst();
   }
-  for ( ;
-        it->Valid() && (!end_key_specified_ || it->key().ToString() < end_key_);
-        it->Next()) {
-
-    auto table_it = new TableIterator(it);
-    // TODO: generalize this to the case where the schema id is a different
-    // column. For now, we assume the first column is schema id.
-    std::vector<Dynamic> key = {
-      Dynamic(Dynamic::T_INT),
-    };
-    std::vector<Dynamic> value;
-    table_it->key(&key);
-    const auto& p = schema_.at(key[0].getInt());
-    key = p.first;
-    value = p.second;
-    table_it->key(&key);
-    table_it->value(&value);
-    PrintVector(key);
-    fprintf(stdout, DELIM);
-    PrintVector(value);
-    fprintf(stdout, "\n");
+  std::unique_ptr<RowFormatter> formatter;
+  NewRowFormatter(output_format_, &schemas_, &formatter);
+  // Rows are formatted into out and written in large chunks.
+  std::string out;
+  // With index_lookup_, the scanned index entries whose rows are read
+  // next.
+  std::vector<std::string> index_keys;
+  for (; it->Valid(); reverse_ ? it->Prev() : it->Next()) {
+    Status st;
+    if (!index_lookup_) {
+      st = formatter->Add(it->key(), it->value(), &out);
+    } else {
+      index_keys.push_back(it->key().ToString());
+      if (index_keys.size() >= static_cast<size_t>(batch_size_)) {
+        st = LookupRows(&index_keys, formatter.get(), &out);
+      }
+    }
+    if (!st.ok()) {
+      exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+      break;
+    }
+    if (out.size() >= kOutputChunkBytes) {
+      fwrite(out.data(), 1, out.size(), stdout);
+      out.clear();
+    }
 
     num_keys_scanned++;
     if (max_keys_scanned_ >= 0 && num_keys_scanned >= max_keys_scanned_) {
       break;
     }
   }
+  if (!index_keys.empty() && exec_state_.IsSucceed()) {
+    Status st = LookupRows(&index_keys, formatter.get(), &out);
+    if (!st.ok()) {
+      exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+    }
+  }
+  formatter->Flush(&out);
+  fwrite(out.data(), 1, out.size(), stdout);
+  if (index_lookup_ && stale_index_entries_ > 0) {
+    fprintf(stderr, "%llu stale index entries\n",
+            (unsigned long long) stale_index_entries_);
+  }
   if (!it->status().ok()) {  // Check for any errors found during the scan
     exec_state_ = LDBCommandExecuteResult::Failed(it->status().ToString());
   }
+  if (skip_scan_column_ >= 0) {
+    seeks_ += static_cast<SkipScanIterator*>(it)->seeks();
+  }
   delete it;
+  ReportSkipScan();
+}
+
+Status TScanCommand::LookupRows(std::vector<std::string>* index_keys,
+                                RowFormatter* formatter, std::string* out) {
+  std::vector<std::string> keys(index_keys->size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    Slice primary_key;
+    Status st = schemas_.IndexedKey((*index_keys)[i], &primary_key);
+    if (!st.ok()) {
+      return st;
+    }
+    keys[i] = primary_key.ToString();
+  }
+  std::vector<std::string> values;
+  std::vector<Status> statuses;
+  std::vector<uint64_t> batch_micros;
+  SortedMultiGet(db_, ReadOptions(), keys, batch_size_, &values, &statuses,
+                 &batch_micros);
+
+  std::vector<std::string> current;
+  Status st;
+  for (size_t i = 0; st.ok() && i < keys.size(); i++) {
+    if (statuses[i].IsNotFound()) {
+      stale_index_entries_++;
+      continue;
+    }
+    if (statuses[i].ok()) {
+      // Entries aren't removed when a row is overwritten, so skip those
+      // the row no longer has.
+      current.clear();
+      st = schemas_.IndexKeys(keys[i], values[i], &current);
+      if (std::find(current.begin(), current.end(), (*index_keys)[i]) ==
+          current.end()) {
+        stale_index_entries_++;
+        continue;
+      }
+    } else {
+      st = statuses[i];
+    }
+    if (st.ok()) {
+      st = formatter->Add(keys[i], values[i], out);
+    }
+  }
+  index_keys->clear();
+  return st;
+}
+
+void TScanCommand::SplitRange(std::vector<std::string>* splits) const {
+  // Cut the range at the smallest keys of SST files, so that each
+  // partition holds about the same bytes of files. Files of different
+  // levels overlap, which makes this approximate, and data only in the
+  // memtables isn't counted.
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  const Comparator* cmp = db_->GetOptions().comparator;
+  std::vector<std::pair<std::string, uint64_t>> starts;
+  uint64_t total = 0;
+  uint64_t before = 0;
+  for (const auto& f : files) {
+    if ((end_key_specified_ && cmp->Compare(f.smallestkey, end_key_) >= 0) ||
+        (start_key_specified_ &&
+         cmp->Compare(f.largestkey, start_key_) < 0)) {
+      continue;
+    }
+    total += f.size;
+    if (start_key_specified_ && cmp->Compare(f.smallestkey, start_key_) <= 0) {
+      before += f.size;
+    } else {
+      starts.emplace_back(f.smallestkey, f.size);
+    }
+  }
+  std::sort(starts.begin(), starts.end(),
+            [cmp](const std::pair<std::string, uint64_t>& a,
+                  const std::pair<std::string, uint64_t>& b) {
+              return cmp->Compare(a.first, b.first) < 0;
+            });
+
+  splits->clear();
+  for (const auto& start : starts) {
+    if (splits->size() + 1 >= static_cast<size_t>(threads_)) {
+      break;
+    }
+    uint64_t target = total / threads_ * (splits->size() + 1);
+    if (before >= target && before > 0 &&
+        (splits->empty() || cmp->Compare(start.first, splits->back()) > 0)) {
+      splits->push_back(start.first);
+    }
+    before += start.second;
+  }
+}
+
+Status TScanCommand::ScanPartition(
+    const std::string* begin, const std::string* end,
+    const std::function<bool(std::string*)>& emit) {
+  Slice lower_bound = begin != nullptr ? Slice(*begin) : Slice();
+  Slice upper_bound = end != nullptr ? Slice(*end) : Slice();
+  ReadOptions read_options =
+      ScanOptions(begin != nullptr ? &lower_bound : nullptr,
+                  end != nullptr ? &upper_bound : nullptr);
+  std::unique_ptr<Iterator> it(NewScanIterator(read_options));
+  std::unique_ptr<RowFormatter> formatter;
+  NewRowFormatter(output_format_, &schemas_, &formatter);
+  std::string chunk;
+  Status st;
+  bool emitted = true;
+  if (begin != nullptr) {
+    it->Seek(*begin);
+  } else {
+    it->SeekToFirst();
+  }
+  for (; emitted && it->Valid(); it->Next()) {
+    st = formatter->Add(it->key(), it->value(), &chunk);
+    if (!st.ok()) {
+      break;
+    }
+    if (chunk.size() >= kOutputChunkBytes) {
+      emitted = emit(&chunk);
+      chunk.clear();
+    }
+  }
+  if (st.ok()) {
+    st = it->status();
+  }
+  if (st.ok() && emitted) {
+    formatter->Flush(&chunk);
+  }
+  if (st.ok() && emitted && !chunk.empty()) {
+    emitted = emit(&chunk);
+  }
+  if (st.ok() && !emitted) {
+    st = Status::IOError("failed to write the output");
+  }
+  if (skip_scan_column_ >= 0) {
+    seeks_ += static_cast<SkipScanIterator*>(it.get())->seeks();
+  }
+  return st;
+}
+
+void TScanCommand::ParallelScan() {
+  std::vector<std::string> splits;
+  SplitRange(&splits);
+  // Partition i is [bounds[i], bounds[i + 1]), where nullptr is
+  // unbounded.
+  std::vector<const std::string*> bounds;
+  bounds.push_back(start_key_specified_ ? &start_key_ : nullptr);
+  for (const auto& split : splits) {
+    bounds.push_back(&split);
+  }
+  bounds.push_back(end_key_specified_ ? &end_key_ : nullptr);
+  const size_t n = bounds.size() - 1;
+
+  // With output_prefix_ every partition is written to its own file.
+  // Otherwise partitions fill bounded queues that this thread copies to
+  // stdout in key order, so a partition runs ahead of the output only by
+  // its queue.
+  std::vector<std::unique_ptr<WorkQueue<std::string>>> outputs;
+  std::vector<Status> results(n);
+  for (size_t i = 0; i < n; i++) {
+    outputs.emplace_back(new WorkQueue<std::string>(kOutputQueueChunks));
+  }
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < n; i++) {
+    workers.emplace_back([&, i]() {
+      if (output_prefix_.empty()) {
+        results[i] = ScanPartition(
+            bounds[i], bounds[i + 1], [&](std::string* chunk) {
+              return outputs[i]->Push(std::move(*chunk));
+            });
+        outputs[i]->Close();
+        return;
+      }
+      const std::string path = output_prefix_ + "." + std::to_string(i);
+      FILE* out = fopen(path.c_str(), "w");
+      if (out == nullptr) {
+        results[i] = Status::IOError(path, strerror(errno));
+        return;
+      }
+      results[i] = ScanPartition(
+          bounds[i], bounds[i + 1], [out](std::string* chunk) {
+            return fwrite(chunk->data(), 1, chunk->size(), out) ==
+                   chunk->size();
+          });
+      if (fclose(out) != 0 && results[i].ok()) {
+        results[i] = Status::IOError(path, strerror(errno));
+      }
+    });
+  }
+
+  Status st;
+  if (output_prefix_.empty()) {
+    std::string chunk;
+    for (size_t i = 0; i < n; i++) {
+      while (outputs[i]->Pop(&chunk)) {
+        fwrite(chunk.data(), 1, chunk.size(), stdout);
+      }
+      if (!results[i].ok()) {
+        // Stop the partitions after it; their output would be cut off.
+        st = results[i];
+        for (auto& output : outputs) {
+          output->Close();
+        }
+        break;
+      }
+    }
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  for (size_t i = 0; st.ok() && i < n; i++) {
+    st = results[i];
+  }
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+  fprintf(stderr, "scanned %zu partitions\n", n);
+  ReportSkipScan();
 }
 
 Options TScanCommand::PrepareOptionsForOpenDB() {
   Options opt = LDBCommand::PrepareOptionsForOpenDB();
-  if (!descending_) {
-    opt.comparator = rocksdb::BytewiseComparator();
+  if (descending_) {
+    opt.comparator = rocksdb::ReverseBytewiseComparator();
+  }
+  return opt;
+}
+
+TDeleteCommand::TDeleteCommand(const vector<string>& params,
+      const map<string, string>& options, const vector<string>& flags) :
+    LDBCommand(options, flags, false,
+               BuildCmdLineOptions({ARG_TO, ARG_FROM, ARG_PREFIX, ARG_ORDER,
+                                    ARG_SCHEMA, ARG_SCHEMA_ID_COLUMN,
+                                    ARG_PREFIX_COLUMNS, ARG_PLAIN_TABLE,
+                                    ARG_WHERE_COLUMN, ARG_WHERE_FROM,
+                                    ARG_WHERE_TO})),
+    has_begin_(false),
+    has_end_(false) {
+  ParseSchemaFile();
+  Status st = ParseKeyRange(options, &begin_, &has_begin_, &end_, &has_end_);
+  int column = -1;
+  KeyColumnRange range;
+  if (st.ok()) {
+    st = ParseColumnRange(options, ARG_WHERE_COLUMN, ARG_WHERE_FROM,
+                          ARG_WHERE_TO, &column, &range);
+  }
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+    return;
+  }
+  // A column without bounds matches every row, so a mistyped option
+  // mustn't turn into deleting the whole DB.
+  if (column >= 0 && range.lower().empty() &&
+      range.upper_successor().empty() && !has_begin_ && !has_end_) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        ARG_WHERE_COLUMN + " needs " + ARG_WHERE_FROM + ", " + ARG_WHERE_TO +
+        " or a key range");
+    return;
+  }
+
+  // A predicate on the column right after a typed --prefix (or on the
+  // first column) narrows the prefix to one contiguous range.
+  size_t prefix_columns = 0;
+  auto itr = options.find(ARG_PREFIX);
+  if (itr != options.end()) {
+    std::vector<Slice> tokens;
+    SplitTokens(itr->second, &tokens);
+    prefix_columns = is_key_hex_ ? std::string::npos : tokens.size();
+  } else if (has_begin_ || has_end_) {
+    prefix_columns = std::string::npos;
+  }
+  if (column >= 0 && static_cast<size_t>(column) == prefix_columns) {
+    std::string prefix = begin_;
+    begin_ = prefix + range.lower();
+    end_ = range.upper_successor().empty() ? PrefixSuccessor(prefix)
+                                           : prefix + range.upper_successor();
+    has_begin_ = true;
+    has_end_ = !end_.empty();
+  } else if (column >= 0) {
+    filter_.reset(new PredicateCompactionFilter(has_begin_ ? begin_ : "",
+                                                has_end_ ? end_ : "",
+                                                range));
+  }
+  if (!filter_ && !has_end_) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        "DeleteRange needs an end: pass " + ARG_TO + ", " + ARG_PREFIX +
+        " or " + ARG_WHERE_TO);
+  }
+}
+
+void TDeleteCommand::Help(string& ret) {
+  ret.append("  ");
+  ret.append(TDeleteCommand::Name());
+  ret.append(HelpRangeCmdArgs());
+  ret.append(" [--" + ARG_PREFIX + "=<key columns>]");
+  ret.append(" [--" + ARG_WHERE_COLUMN + "=<N>");
+  ret.append(" [--" + ARG_WHERE_FROM + "=<value>]");
+  ret.append(" [--" + ARG_WHERE_TO + "=<value>]]");
+  ret.append(" [--" + ARG_ORDER + "=desc]");
+  ret.append(" [--" + ARG_SCHEMA + "]");
+  ret.append(" [--" + ARG_SCHEMA_ID_COLUMN + "=<N>]");
+  ret.append(" [--" + ARG_PREFIX_COLUMNS + "=<N>]");
+  ret.append(" [--" + ARG_PLAIN_TABLE + "]");
+  ret.append("\n");
+}
+
+void TDeleteCommand::DoCommand() {
+  Status st;
+  if (filter_) {
+    // The filter drops the matching rows as the compaction rewrites the
+    // range, down to the bottommost level where no tombstones are left.
+    Slice begin(begin_);
+    Slice end(end_);
+    CompactRangeOptions compact_options;
+    compact_options.bottommost_level_compaction =
+      BottommostLevelCompaction::kForce;
+    st = db_->CompactRange(compact_options, has_begin_ ? &begin : nullptr,
+                           has_end_ ? &end : nullptr);
+    if (st.ok()) {
+      fprintf(stdout, "Deleted %llu rows\nOK\n",
+              (unsigned long long) filter_->removed());
+    }
+  } else {
+    // One range tombstone instead of a tombstone per row.
+    st = db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), begin_,
+                          end_);
+    if (st.ok()) {
+      fprintf(stdout, "OK\n");
+    }
+  }
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+}
+
+Options TDeleteCommand::PrepareOptionsForOpenDB() {
+  Options opt = LDBCommand::PrepareOptionsForOpenDB();
+  if (descending_) {
+    opt.comparator = rocksdb::ReverseBytewiseComparator();
+  }
+  if (filter_) {
+    // Takes precedence over the TTL filter factory for this compaction;
+    // expired rows are dropped by the next one.
+    opt.compaction_filter = filter_.get();
+  }
+  return opt;
+}
+
+TGetCommand::TGetCommand(const vector<string>& params,
+      const map<string, string>& options, const vector<string>& flags) :
+    LDBCommand(options, flags, true,
+               BuildCmdLineOptions({ARG_ORDER, ARG_SCHEMA,
+                                    ARG_SCHEMA_ID_COLUMN, ARG_PREFIX_COLUMNS,
+                                    ARG_PLAIN_TABLE, ARG_BATCH_SIZE,
+                                    ARG_OUTPUT})),
+    keys_(params),
+    batch_size_(64),
+    output_format_("text") {
+  if (ParseIntOption(options, ARG_BATCH_SIZE, batch_size_, exec_state_) &&
+      batch_size_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_BATCH_SIZE +
+                                                  " must be at least 1");
+  }
+  auto itr = options.find(ARG_OUTPUT);
+  if (itr != options.end()) {
+    output_format_ = itr->second;
+  }
+  ParseSchemaFile();
+  std::unique_ptr<RowFormatter> formatter;
+  Status st = NewRowFormatter(output_format_, &schemas_, &formatter);
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+}
+
+void TGetCommand::Help(string& ret) {
+  ret.append("  ");
+  ret.append(TGetCommand::Name());
+  ret.append(" [<keys>...]");
+  ret.append(" [--" + ARG_BATCH_SIZE + "=<N>]");
+  ret.append(" [--" + ARG_OUTPUT + "=text|binary|columnar]");
+  ret.append(" [--" + ARG_ORDER + "=desc]");
+  ret.append(" [--" + ARG_SCHEMA + "]");
+  ret.append(" [--" + ARG_SCHEMA_ID_COLUMN + "=<N>]");
+  ret.append(" [--" + ARG_PREFIX_COLUMNS + "=<N>]");
+  ret.append(" [--" + ARG_PLAIN_TABLE + "]");
+  ret.append("\n");
+  ret.append("Each key is one argument of space separated columns, or one "
+             "line of stdin\n");
+}
+
+void TGetCommand::DoCommand() {
+  if (keys_.empty()) {
+    std::string line;
+    while (getline(std::cin, line, '\n')) {
+      if (!line.empty()) {
+        keys_.push_back(line);
+      }
+    }
+  }
+  std::vector<std::string> encoded(keys_.size());
+  for (size_t i = 0; i < keys_.size(); i++) {
+    Status st;
+    if (is_key_hex_) {
+      encoded[i] = HexToString(keys_[i]);
+    } else {
+      st = EncodeKeyPrefix(keys_[i], &encoded[i]);
+    }
+    if (!st.ok()) {
+      exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+      return;
+    }
+  }
+
+  std::vector<std::string> values;
+  std::vector<Status> statuses;
+  std::vector<uint64_t> batch_micros;
+  SortedMultiGet(db_, ReadOptions(), encoded, batch_size_, &values,
+                 &statuses, &batch_micros);
+
+  // Rows are printed in the order of the keys; missing keys go to
+  // stderr.
+  std::unique_ptr<RowFormatter> formatter;
+  NewRowFormatter(output_format_, &schemas_, &formatter);
+  std::string out;
+  Status st;
+  for (size_t i = 0; st.ok() && i < keys_.size(); i++) {
+    if (statuses[i].ok()) {
+      st = formatter->Add(encoded[i], values[i], &out);
+    } else if (statuses[i].IsNotFound()) {
+      fprintf(stderr, "not found: %s\n", keys_[i].c_str());
+    } else {
+      st = statuses[i];
+    }
+  }
+  formatter->Flush(&out);
+  fwrite(out.data(), 1, out.size(), stdout);
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+  ReportLatency(&batch_micros);
+}
+
+void TGetCommand::ReportLatency(std::vector<uint64_t>* batch_micros) const {
+  if (batch_micros->empty()) {
+    return;
+  }
+  std::sort(batch_micros->begin(), batch_micros->end());
+  auto percentile = [batch_micros](size_t p) {
+    size_t n = batch_micros->size();
+    return (unsigned long long) (*batch_micros)[std::min(n - 1, n * p / 100)];
+  };
+  fprintf(stderr,
+          "%zu keys in %zu batches of up to %d, batch latency (us): "
+          "p50 %llu p90 %llu p99 %llu max %llu\n",
+          keys_.size(), batch_micros->size(), batch_size_, percentile(50),
+          percentile(90), percentile(99),
+          (unsigned long long) batch_micros->back());
+}
+
+Options TGetCommand::PrepareOptionsForOpenDB() {
+  Options opt = LDBCommand::PrepareOptionsForOpenDB();
+  if (descending_) {
+    opt.comparator = rocksdb::ReverseBytewiseComparator();
   }
   return opt;
 }
@@ -269,7 +1423,36 @@ TLoadCommand::TLoadCommand(const vector<string>& params,
       const map<string, string>& options, const vector<string>& flags) :
   LDBCommand(options, flags, false,
              BuildCmdLineOptions({ARG_CREATE_IF_MISSING, ARG_ORDER,
-                                  ARG_SCHEMA})) {
+                                  ARG_SCHEMA, ARG_THREADS, ARG_BULK_LOAD,
+                                  ARG_BATCH_SIZE, ARG_BATCH_BYTES,
+                                  ARG_DISABLE_WAL, ARG_INPUT,
+                                  ARG_SCHEMA_ID_COLUMN,
+                                  ARG_PREFIX_COLUMNS, ARG_PLAIN_TABLE})),
+  bulk_load_(IsFlagPresent(flags, ARG_BULK_LOAD)),
+  disable_wal_(IsFlagPresent(flags, ARG_DISABLE_WAL)),
+  threads_(1),
+  batch_size_(1000),
+  batch_bytes_(4 << 20),
+  parse_errors_(0) {
+  if (ParseIntOption(options, ARG_THREADS, threads_, exec_state_) &&
+      threads_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_THREADS +
+                                                  " must be at least 1");
+  }
+  if (ParseIntOption(options, ARG_BATCH_SIZE, batch_size_, exec_state_) &&
+      batch_size_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_BATCH_SIZE +
+                                                  " must be at least 1");
+  }
+  if (ParseIntOption(options, ARG_BATCH_BYTES, batch_bytes_, exec_state_) &&
+      batch_bytes_ < 1) {
+    exec_state_ = LDBCommandExecuteResult::Failed(ARG_BATCH_BYTES +
+                                                  " must be at least 1");
+  }
+  auto itr = options.find(ARG_INPUT);
+  if (itr != options.end()) {
+    input_path_ = itr->second;
+  }
   ParseSchemaFile();
 }
 
@@ -278,43 +1461,359 @@ void TLoadCommand::Help(string& ret) {
   ret.append(TLoadCommand::Name());
   ret.append(" [--" + ARG_TTL + "]");
   ret.append(" [--" + ARG_SCHEMA + "]");
-  ret.append(" [--" + ARG_ORDER + "]");
+  ret.append(" [--" + ARG_SCHEMA_ID_COLUMN + "=<N>]");
+  ret.append(" [--" + ARG_PREFIX_COLUMNS + "=<N>]");
+  ret.append(" [--" + ARG_PLAIN_TABLE + "]");
+  ret.append(" [--" + ARG_ORDER + "=desc]");
+  ret.append(" [--" + ARG_BULK_LOAD + "]");
+  ret.append(" [--" + ARG_THREADS + "=<N>]");
+  ret.append(" [--" + ARG_BATCH_SIZE + "=<rows>]");
+  ret.append(" [--" + ARG_BATCH_BYTES + "=<bytes>]");
+  ret.append(" [--" + ARG_DISABLE_WAL + "]");
+  ret.append(" [--" + ARG_INPUT + "=<path>]");
   ret.append("\n");
+  ret.append("--" + ARG_BULK_LOAD + " sorts rows on N threads into SST "
+             "files and ingests them; the last of duplicate keys wins\n");
 }
 
 void TLoadCommand::DoCommand() {
+  if (!input_path_.empty()) {
+    Status st = MappedFile::Open(input_path_, &input_);
+    if (!st.ok()) {
+      exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+      return;
+    }
+  }
+  if (bulk_load_) {
+    BulkLoad();
+  } else {
+    PipelinedLoad();
+  }
+  if (exec_state_.IsSucceed() && parse_errors_ > 0) {
+    exec_state_ = LDBCommandExecuteResult::Failed(
+        std::to_string(parse_errors_) + " lines could not be parsed");
+  }
+}
+
+void TLoadCommand::ReportLineError(size_t line, const Status& st) {
+  parse_errors_++;
+  fprintf(stderr, "line %zu: %s\n", line, st.ToString().c_str());
+}
+
+void TLoadCommand::ReadChunks(WorkQueue<LineChunk>* chunks) const {
+  if (input_) {
+    ReadMappedChunks(chunks);
+    return;
+  }
+  LineChunk chunk = {0, 1, std::string(), Slice()};
+  size_t lines = 0;
   std::string line;
-  size_t count = 1;
   while (getline(std::cin, line, '\n')) {
-    stringstream ss(line);
-    std::vector<string> params;
+    chunk.buffer.append(line).push_back('\n');
+    lines++;
+    if (lines >= (size_t) batch_size_ ||
+        chunk.buffer.size() >= (size_t) batch_bytes_) {
+      LineChunk next = {chunk.seq + 1, chunk.first_line + lines,
+                        std::string(), Slice()};
+      if (!chunks->Push(std::move(chunk))) {
+        return;
+      }
+      chunk = std::move(next);
+      lines = 0;
+    }
+  }
+  if (lines > 0) {
+    chunks->Push(std::move(chunk));
+  }
+}
 
-    while (true) {
-      std::string one;
-      if (!std::getline(ss, one, ' ')) {
-        break;
+void TLoadCommand::ReadMappedChunks(WorkQueue<LineChunk>* chunks) const {
+  // Only line boundaries are found here; the workers split the lines
+  // into tokens and parse them in place.
+  Slice rest = input_->data();
+  size_t seq = 0;
+  size_t line_no = 1;
+  while (!rest.empty()) {
+    const char* begin = rest.data();
+    size_t lines = 0;
+    while (!rest.empty() && lines < (size_t) batch_size_ &&
+           (size_t) (rest.data() - begin) < (size_t) batch_bytes_) {
+      NextLine(&rest);
+      lines++;
+    }
+    LineChunk chunk = {seq++, line_no, std::string(),
+                       Slice(begin, rest.data() - begin)};
+    line_no += lines;
+    if (!chunks->Push(std::move(chunk))) {
+      return;
+    }
+  }
+}
+
+void TLoadCommand::EncodeBatches(WorkQueue<LineChunk>* chunks,
+                                 WorkQueue<EncodedBatch>* batches) {
+  KeyBuilder row;
+  std::vector<Slice> tokens;
+  std::vector<std::string> index_keys;
+  LineChunk chunk;
+  while (chunks->Pop(&chunk)) {
+    EncodedBatch encoded = {chunk.seq, 0,
+                            std::unique_ptr<WriteBatch>(new WriteBatch())};
+    Slice rest = chunk.text();
+    for (size_t line_no = chunk.first_line; !rest.empty(); line_no++) {
+      Slice line = NextLine(&rest);
+      if (line.empty()) {
+        continue;
+      }
+      row.Reset();
+      Status st = EncodeLine(line, &tokens, row.mutable_key(),
+                             row.mutable_value());
+      index_keys.clear();
+      if (st.ok()) {
+        st = schemas_.IndexKeys(*row.mutable_key(), row.value(),
+                                &index_keys);
       }
-      params.push_back(one);
+      if (!st.ok()) {
+        ReportLineError(line_no, st);
+        continue;
+      }
+      row.PutTo(encoded.batch.get());
+      for (const auto& index_key : index_keys) {
+        encoded.batch->Put(index_key, Slice());
+      }
+      encoded.rows++;
+    }
+    if (!batches->Push(std::move(encoded))) {
+      return;
     }
-    key_.clear();
-    value_.clear();
-    ParseKeyValue(key_, value_, params);
+  }
+}
 
-    Status st = TableInterface::Put(db_, WriteOptions(), key_, value_);
-    if (!st.ok()) {
-      exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+void TLoadCommand::PipelinedLoad() {
+  // reader thread -> threads_ encoders -> DB::Write on this thread
+  WorkQueue<LineChunk> chunks(2 * threads_);
+  WorkQueue<EncodedBatch> batches(2 * threads_);
+  std::thread reader([&]() {
+    ReadChunks(&chunks);
+    chunks.Close();
+  });
+  std::atomic<int> encoders_running(threads_);
+  std::vector<std::thread> encoders;
+  for (int i = 0; i < threads_; i++) {
+    encoders.emplace_back([&]() {
+      EncodeBatches(&chunks, &batches);
+      if (--encoders_running == 0) {
+        batches.Close();
+      }
+    });
+  }
+
+  WriteOptions write_options;
+  write_options.disableWAL = disable_wal_;
+  LoadProgress progress;
+  // Batches can finish encoding out of order; write them in input order
+  // so that later rows still overwrite earlier ones.
+  std::map<size_t, EncodedBatch> pending;
+  size_t next_seq = 0;
+  Status st;
+  EncodedBatch encoded;
+  while (st.ok() && batches.Pop(&encoded)) {
+    size_t seq = encoded.seq;
+    pending[seq] = std::move(encoded);
+    for (auto it = pending.begin();
+         st.ok() && it != pending.end() && it->first == next_seq;
+         it = pending.erase(it), next_seq++) {
+      WriteBatch* batch = it->second.batch.get();
+      if (batch->Count() > 0) {
+        st = SaveDictionaries();
+      }
+      if (st.ok() && batch->Count() > 0) {
+        st = db_->Write(write_options, batch);
+      }
+      progress.Add(it->second.rows, batch->GetDataSize());
     }
-    if (count++ % 10000 == 0) {
-      fprintf(stdout, ".");
+  }
+  if (!st.ok()) {
+    // Unblock the other stages.
+    chunks.Close();
+    batches.Close();
+  }
+  reader.join();
+  for (auto& e : encoders) {
+    e.join();
+  }
+  if (st.ok() && disable_wal_) {
+    // Nothing was logged, so persist the memtables before returning.
+    st = db_->Flush(FlushOptions());
+  }
+  progress.Finish();
+
+  if (st.ok()) {
+    fprintf(stdout, "OK\n");
+  } else {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+}
+
+void TLoadCommand::BulkLoad() {
+  Env* env = Env::Default();
+  const std::string sst_dir = db_path_ + "/tload_sst";
+  Status st = env->CreateDirIfMissing(sst_dir);
+  if (!st.ok()) {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+    return;
+  }
+
+  WorkQueue<LineChunk> chunks(2 * threads_);
+  std::vector<std::vector<std::string>> runs(threads_);
+  std::vector<Status> results(threads_);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads_; i++) {
+    workers.emplace_back([&, i]() {
+      results[i] = SpillSortedRuns(&chunks, sst_dir, i, &runs[i]);
+      if (!results[i].ok()) {
+        // Stop the reader, the load has failed.
+        chunks.Close();
+      }
+    });
+  }
+
+  ReadChunks(&chunks);
+  chunks.Close();
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  std::vector<std::string> all_runs;
+  for (int i = 0; i < threads_; i++) {
+    if (st.ok()) {
+      st = results[i];
     }
+    all_runs.insert(all_runs.end(), runs[i].begin(), runs[i].end());
+  }
+  // The runs of different workers overlap, so they are merged into SST
+  // files that don't, and ingestion can place each file in the lowest
+  // level it fits in.
+  std::vector<std::string> files;
+  if (st.ok()) {
+    st = WriteSstFiles(all_runs, sst_dir, &files);
+  }
+  for (const auto& f : all_runs) {
+    env->DeleteFile(f);
+  }
+  if (st.ok()) {
+    st = SaveDictionaries();
+  }
+  if (st.ok() && !files.empty()) {
+    IngestExternalFileOptions ingest_options;
+    ingest_options.move_files = true;
+    st = db_->IngestExternalFile(files, ingest_options);
+  }
+  // Ingestion moves the files, so this only cleans up after a failure.
+  for (const auto& f : files) {
+    env->DeleteFile(f);
+  }
+  env->DeleteDir(sst_dir);
+
+  if (st.ok()) {
+    fprintf(stdout, "Ingested %zu files\nOK\n", files.size());
+  } else {
+    exec_state_ = LDBCommandExecuteResult::Failed(st.ToString());
+  }
+}
+
+Status TLoadCommand::SpillSortedRuns(WorkQueue<LineChunk>* chunks,
+                                     const std::string& sst_dir, int worker,
+                                     std::vector<std::string>* runs) {
+  Env* env = Env::Default();
+  const Comparator* cmp = db_->GetOptions().comparator;
+  std::vector<RunRow> rows;
+  size_t bytes = 0;
+  LineChunk chunk;
+  std::vector<Slice> tokens;
+  std::vector<std::string> index_keys;
+  Status st;
+  while (st.ok() && chunks->Pop(&chunk)) {
+    Slice rest = chunk.text();
+    for (size_t line_no = chunk.first_line; !rest.empty(); line_no++) {
+      Slice line = NextLine(&rest);
+      if (line.empty()) {
+        continue;
+      }
+      rows.emplace_back();
+      RunRow& row = rows.back();
+      row.line = line_no;
+      Status parsed = EncodeLine(line, &tokens, &row.key, &row.value);
+      index_keys.clear();
+      if (parsed.ok()) {
+        parsed = schemas_.IndexKeys(row.key, row.value, &index_keys);
+      }
+      if (!parsed.ok()) {
+        ReportLineError(line_no, parsed);
+        rows.pop_back();
+        continue;
+      }
+      bytes += row.key.size() + row.value.size();
+      // Index entries are ingested with their rows.
+      for (auto& index_key : index_keys) {
+        bytes += index_key.size();
+        rows.push_back(RunRow{line_no, std::move(index_key), std::string()});
+      }
+    }
+    if (bytes >= kBulkLoadFileSize) {
+      runs->push_back(sst_dir + "/" + std::to_string(worker) + "_" +
+                      std::to_string(runs->size()) + ".run");
+      st = WriteSortedRun(env, cmp, &rows, runs->back());
+      rows.clear();
+      bytes = 0;
+    }
+  }
+  if (st.ok() && !rows.empty()) {
+    runs->push_back(sst_dir + "/" + std::to_string(worker) + "_" +
+                    std::to_string(runs->size()) + ".run");
+    st = WriteSortedRun(env, cmp, &rows, runs->back());
+  }
+  return st;
+}
+
+Status TLoadCommand::WriteSstFiles(const std::vector<std::string>& runs,
+                                   const std::string& sst_dir,
+                                   std::vector<std::string>* files) const {
+  Options options = db_->GetOptions();
+  std::unique_ptr<SstFileWriter> writer;
+  size_t bytes = 0;
+  Status st = MergeSortedRuns(
+      Env::Default(), options.comparator, runs,
+      [&](const Slice& key, const Slice& value) {
+        // Keys are unique, so each file covers its own key range.
+        Status s;
+        if (writer && bytes >= kBulkLoadFileSize) {
+          s = writer->Finish();
+          writer.reset();
+        }
+        if (s.ok() && !writer) {
+          files->push_back(sst_dir + "/" + std::to_string(files->size()) +
+                           ".sst");
+          writer.reset(new SstFileWriter(EnvOptions(), options));
+          s = writer->Open(files->back());
+          bytes = 0;
+        }
+        if (s.ok()) {
+          s = writer->Put(key, value);
+          bytes += key.size() + value.size();
+        }
+        return s;
+      });
+  if (st.ok() && writer) {
+    st = writer->Finish();
   }
-  fprintf(stdout, "\nOK\n");
+  return st;
 }
 
 Options TLoadCommand::PrepareOptionsForOpenDB() {
   Options opt = LDBCommand::PrepareOptionsForOpenDB();
-  if (!descending_) {
-    opt.comparator = rocksdb::BytewiseComparator();
+  if (descending_) {
+    opt.comparator = rocksdb::ReverseBytewiseComparator();
   }
   opt.create_if_missing = IsFlagPresent(flags_, ARG_CREATE_IF_MISSING);
   return opt;
@@ -332,6 +1831,10 @@ rocksdb::LDBCommand* LDBCommand::SelectCommand(
     return new TScanCommand(cmdParams, option_map, flags);
   } else if (cmd == TLoadCommand::Name()) {
     return new TLoadCommand(cmdParams, option_map, flags);
+  } else if (cmd == TDeleteCommand::Name()) {
+    return new TDeleteCommand(cmdParams, option_map, flags);
+  } else if (cmd == TGetCommand::Name()) {
+    return new TGetCommand(cmdParams, option_map, flags);
   }
 
   auto cmdPtr = rocksdb::LDBCommand::SelectCommand(cmd, cmdParams, option_map,
@@ -5,13 +5,25 @@
 
 #include "rocksdb/utilities/ldb_cmd.h"
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "rocksdb/utilities/key_builder.h"
 #include "rocksdb/utilities/table_interface.h"
 #include "rocksdb/utilities/table_serialization.h"
+#include "utilities/table/input_parser.h"
+#include "utilities/table/key_column_range.h"
+#include "utilities/table/predicate_compaction_filter.h"
+#include "utilities/table/row_formatter.h"
+#include "utilities/table/schema_registry.h"
+#include "utilities/table/string_dictionary.h"
+#include "utilities/table/table_schema.h"
+#include "utilities/table/work_queue.h"
 
 namespace rocksdb { namespace table {
 
@@ -19,6 +31,26 @@ class LDBCommand : public rocksdb::LDBCommand {
  public:
   static const std::string ARG_ORDER;
   static const std::string ARG_SCHEMA;
+  static const std::string ARG_THREADS;
+  static const std::string ARG_BULK_LOAD;
+  static const std::string ARG_BATCH_SIZE;
+  static const std::string ARG_BATCH_BYTES;
+  static const std::string ARG_DISABLE_WAL;
+  static const std::string ARG_INPUT;
+  static const std::string ARG_SCHEMA_ID_COLUMN;
+  static const std::string ARG_PREFIX_COLUMNS;
+  static const std::string ARG_PREFIX;
+  static const std::string ARG_REVERSE;
+  static const std::string ARG_SKIP_SCAN_COLUMN;
+  static const std::string ARG_SKIP_SCAN_FROM;
+  static const std::string ARG_SKIP_SCAN_TO;
+  static const std::string ARG_WHERE_COLUMN;
+  static const std::string ARG_WHERE_FROM;
+  static const std::string ARG_WHERE_TO;
+  static const std::string ARG_OUTPUT_PREFIX;
+  static const std::string ARG_OUTPUT;
+  static const std::string ARG_INDEX_LOOKUP;
+  static const std::string ARG_PLAIN_TABLE;
 
   template <typename Selector>
   static rocksdb::LDBCommand* InitFromCmdLineArgs(
@@ -46,16 +78,66 @@ class LDBCommand : public rocksdb::LDBCommand {
   LDBCommand(const std::map<std::string, std::string>& options, const std::vector<std::string>& flags,
              bool is_read_only, const std::vector<std::string>& valid_cmd_line_options);
 
+  // Sets a ColumnPrefixTransform over the leading key columns, with
+  // prefix bloom filters in the memtables and SST files, or PlainTable
+  // files with --plain_table.
+  virtual Options PrepareOptionsForOpenDB() override;
+
  protected:
   void ParseSchemaFile();
-  static void ParseKeyValue(std::vector<rocksdb::Dynamic>& key,
-                            std::vector<rocksdb::Dynamic>& val,
-                            const std::vector<std::string>& params);
-
+  // Encode leading key columns given as space separated values, as in
+  // tput. The columns take the types of their schema when the schema id
+  // is among them, or when every schema agrees on them. The prefix is
+  // only looked up, so strings missing from a dictionary aren't added.
+  Status EncodeKeyPrefix(const std::string& text, std::string* out) const;
+  // Encode --from, --to and --prefix into key bounds; begin is inclusive
+  // and end exclusive. With --hex they are raw encoded keys.
+  Status ParseKeyRange(const std::map<std::string, std::string>& options,
+                       std::string* begin, bool* has_begin,
+                       std::string* end, bool* has_end) const;
+  // Parse the range of one key column given by the options column_arg,
+  // from_arg and to_arg. *column is -1 if column_arg is absent. The
+  // column and the ones before it must have the same spec in every
+  // schema. Like a key prefix, the bounds are only looked up.
+  Status ParseColumnRange(const std::map<std::string, std::string>& options,
+                          const std::string& column_arg,
+                          const std::string& from_arg,
+                          const std::string& to_arg, int* column,
+                          KeyColumnRange* range) const;
+  // Encode one "<keys> ==> <values>" input line straight from its text,
+  // like EncodeTokens. tokens is scratch space.
+  Status EncodeLine(const Slice& line, std::vector<Slice>* tokens,
+                    std::string* encoded_key,
+                    std::string* encoded_val) const;
+  // Encode a row given as "<keys> ==> <values>" tokens with the schema of
+  // its schema id. Once schemas are loaded, a row without a known schema
+  // id or with a different number of columns than its schema fails.
+  // Without schemas, quoted tokens are strings and the rest ints.
+  Status EncodeTokens(const std::vector<Slice>& tokens,
+                      std::string* encoded_key,
+                      std::string* encoded_val) const;
+  // Set a PlainTable factory for --plain_table.
+  void UsePlainTable(Options* opt);
+  // The dictionary called name, loaded from the DB directory the first
+  // time a schema refers to it.
+  Status OpenDictionary(const std::string& name,
+                        std::shared_ptr<StringDictionary>* dictionary);
+  // Persist strings added to the dictionaries. Commands that write rows
+  // call it before writing them, so that every stored code is known.
+  Status SaveDictionaries();
+
+  // Open the DB with ReverseBytewiseComparator. Only needed for DBs
+  // created before columns could be marked descending in the schema.
   bool descending_;
   std::string schema_path_;
-  std::map<int64_t,
-           std::pair<std::vector<Dynamic>, std::vector<Dynamic>>> schema_;
+  SchemaRegistry schemas_;
+  // Key columns in the prefix extractor. -1 means up to and including
+  // the schema id column when a schema file is given, 0 means none.
+  int prefix_columns_;
+  // Store SST files in PlainTable format; keys must have a fixed length.
+  bool plain_table_;
+  // By name, see OpenDictionary.
+  std::map<std::string, std::shared_ptr<StringDictionary>> dictionaries_;
 };
 
 class TPutCommand : public LDBCommand {
@@ -73,8 +155,7 @@ class TPutCommand : public LDBCommand {
   virtual Options PrepareOptionsForOpenDB() override;
 
  private:
-  std::vector<rocksdb::Dynamic> key_;
-  std::vector<rocksdb::Dynamic> value_;
+  std::vector<std::string> row_;
 };
 
 class TLoadCommand : public LDBCommand {
@@ -92,8 +173,58 @@ class TLoadCommand : public LDBCommand {
   virtual Options PrepareOptionsForOpenDB() override;
 
  private:
-  std::vector<rocksdb::Dynamic> key_;
-  std::vector<rocksdb::Dynamic> value_;
+  // Consecutive input lines. seq numbers the chunks in input order.
+  // Lines read from stdin are copied into buffer; lines of a mapped
+  // input file are referenced in place by data.
+  struct LineChunk {
+    size_t seq;
+    size_t first_line;
+    std::string buffer;
+    Slice data;
+
+    Slice text() const { return buffer.empty() ? data : Slice(buffer); }
+  };
+
+  // The rows of one LineChunk, encoded into a batch.
+  struct EncodedBatch {
+    size_t seq;
+    size_t rows;
+    std::unique_ptr<WriteBatch> batch;
+  };
+
+  // Split the input into chunks of at most batch_size_ lines and
+  // batch_bytes_ bytes, until the input ends or chunks is closed.
+  void ReadChunks(WorkQueue<LineChunk>* chunks) const;
+  void ReadMappedChunks(WorkQueue<LineChunk>* chunks) const;
+
+  // Parse and encode chunks into batches on threads_ workers, and write
+  // the batches in input order from this thread.
+  void PipelinedLoad();
+  void EncodeBatches(WorkQueue<LineChunk>* chunks,
+                     WorkQueue<EncodedBatch>* batches);
+
+  // Parse and encode rows on threads_ workers, which spill them to sorted
+  // runs, then merge the runs into SST files with disjoint key ranges and
+  // ingest all of the files at the end.
+  void BulkLoad();
+  Status SpillSortedRuns(WorkQueue<LineChunk>* chunks,
+                         const std::string& sst_dir, int worker,
+                         std::vector<std::string>* runs);
+  Status WriteSstFiles(const std::vector<std::string>& runs,
+                       const std::string& sst_dir,
+                       std::vector<std::string>* files) const;
+
+  void ReportLineError(size_t line, const Status& st);
+
+  bool bulk_load_;
+  bool disable_wal_;
+  int threads_;
+  int batch_size_;
+  int batch_bytes_;
+  std::atomic<size_t> parse_errors_;
+  std::string input_path_;
+  // The --input file, mapped for the duration of the load.
+  std::unique_ptr<MappedFile> input_;
 };
 
 class TScanCommand : public LDBCommand {
@@ -111,27 +242,104 @@ class TScanCommand : public LDBCommand {
   virtual Options PrepareOptionsForOpenDB() override;
 
  private:
+  // Rows a partition formats before handing them to the output, and the
+  // formatted chunks it may queue ahead of stdout.
+  static const size_t kOutputChunkBytes = 1 << 20;
+  static const size_t kOutputQueueChunks = 16;
+
+  // Read options for a scan within lower and upper, either of which may
+  // be nullptr. They must outlive the scan.
+  ReadOptions ScanOptions(const Slice* lower, const Slice* upper);
+  Iterator* NewScanIterator(const ReadOptions& read_options);
+  void ReportSkipScan() const;
+
+  // Scan the range as partitions of about equal size on threads_
+  // threads, each writing to stdout in key order or to its own file.
+  void ParallelScan();
+  // Read and format the rows of the scanned index entries, and clear
+  // them.
+  Status LookupRows(std::vector<std::string>* index_keys,
+                    RowFormatter* formatter, std::string* out);
+  // Keys at which to cut the range into at most threads_ partitions.
+  void SplitRange(std::vector<std::string>* splits) const;
+  // Scan [begin, end), passing formatted rows to emit in chunks. emit
+  // returns false if the output failed.
+  Status ScanPartition(const std::string* begin, const std::string* end,
+                       const std::function<bool(std::string*)>& emit);
+
   std::string start_key_;
   std::string end_key_;
   bool start_key_specified_;
   bool end_key_specified_;
   int max_keys_scanned_;
+  // Scan from the end of the range backwards.
+  bool reverse_;
+  // Skip scan on a key column, -1 if none. See SkipScanIterator.
+  int skip_scan_column_;
+  KeyColumnRange skip_scan_;
+  int threads_;
+  // Write partition i to <output_prefix_>.<i> rather than to stdout.
+  std::string output_prefix_;
+  // text, binary or columnar; see RowFormatter.
+  std::string output_format_;
+  // The range holds index entries; print the rows they point to,
+  // batch_size_ rows per MultiGet.
+  bool index_lookup_;
+  int batch_size_;
+  uint64_t stale_index_entries_;
+  std::atomic<uint64_t> seeks_;
+  std::atomic<uint64_t> files_skipped_;
+};
+
+class TDeleteCommand : public LDBCommand {
+ public:
+  static std::string Name() { return "tdelete"; }
+
+  TDeleteCommand(const std::vector<std::string>& params,
+                 const std::map<std::string, std::string>& options,
+                 const std::vector<std::string>& flags);
 
-  std::vector<rocksdb::Dynamic> key_;
-  std::vector<rocksdb::Dynamic> value_;
+  virtual void DoCommand() override;
+
+  static void Help(std::string& ret);
+
+  virtual Options PrepareOptionsForOpenDB() override;
+
+ private:
+  std::string begin_;
+  std::string end_;
+  bool has_begin_;
+  bool has_end_;
+  // Set for --where_column predicates that aren't a contiguous key
+  // range. The rows are then dropped by compacting the range instead of
+  // with DeleteRange.
+  std::unique_ptr<PredicateCompactionFilter> filter_;
 };
 
-inline void PrintVector(const std::vector<Dynamic>& vec) {
-  bool first = true;
-  for (const auto& r : vec) {
-    if (!first) {
-      fputs(", ", stdout);
-    } else {
-      first = false;
-    }
-    fputs(r.toString().c_str(), stdout);
-  }
-}
+class TGetCommand : public LDBCommand {
+ public:
+  static std::string Name() { return "tget"; }
+
+  TGetCommand(const std::vector<std::string>& params,
+              const std::map<std::string, std::string>& options,
+              const std::vector<std::string>& flags);
+
+  virtual void DoCommand() override;
+
+  static void Help(std::string& ret);
+
+  virtual Options PrepareOptionsForOpenDB() override;
+
+ private:
+  // Print percentiles of the MultiGet latencies to stderr.
+  void ReportLatency(std::vector<uint64_t>* batch_micros) const;
+
+  // Keys as typed, from the command line or else from stdin.
+  std::vector<std::string> keys_;
+  int batch_size_;
+  // text, binary or columnar; see RowFormatter.
+  std::string output_format_;
+};
 
 class LDBCommandRunner {
  public:
@@ -144,6 +352,8 @@ class LDBCommandRunner {
     TPutCommand::Help(ret);
     TScanCommand::Help(ret);
     TLoadCommand::Help(ret);
+    TDeleteCommand::Help(ret);
+    TGetCommand::Help(ret);
 
     fprintf(stderr, "%s\n", ret.c_str());
   }
@@ -0,0 +1,63 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/multi_get.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "rocksdb/comparator.h"
+
+namespace rocksdb { namespace table {
+
+void SortedMultiGet(DB* db, const ReadOptions& read_options,
+                    const std::vector<std::string>& keys, size_t batch_size,
+                    std::vector<std::string>* values,
+                    std::vector<Status>* statuses,
+                    std::vector<uint64_t>* batch_micros) {
+  typedef std::chrono::steady_clock Clock;
+  assert(batch_size > 0);
+
+  const Comparator* cmp = db->GetOptions().comparator;
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return cmp->Compare(keys[a], keys[b]) < 0;
+  });
+
+  values->assign(keys.size(), std::string());
+  statuses->assign(keys.size(), Status());
+  batch_micros->clear();
+  std::vector<Slice> batch_keys(std::min(batch_size, keys.size()));
+  std::unique_ptr<PinnableSlice[]> batch_values(
+      new PinnableSlice[batch_keys.size()]);
+  std::vector<Status> batch_statuses(batch_keys.size());
+  for (size_t start = 0; start < order.size(); start += batch_size) {
+    size_t n = std::min(batch_size, order.size() - start);
+    for (size_t i = 0; i < n; i++) {
+      batch_keys[i] = keys[order[start + i]];
+    }
+    Clock::time_point begin = Clock::now();
+    db->MultiGet(read_options, db->DefaultColumnFamily(), n,
+                 batch_keys.data(), batch_values.get(),
+                 batch_statuses.data(), true /* sorted_input */);
+    batch_micros->push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - begin).count());
+    for (size_t i = 0; i < n; i++) {
+      size_t index = order[start + i];
+      (*statuses)[index] = batch_statuses[i];
+      if (batch_statuses[i].ok()) {
+        (*values)[index].assign(batch_values[i].data(),
+                                batch_values[i].size());
+      }
+      batch_values[i].Reset();
+    }
+  }
+}
+
+}}  // namespace rocksdb::table
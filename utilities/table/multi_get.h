@@ -0,0 +1,29 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb { namespace table {
+
+// Look up encoded keys with the batched DB::MultiGet, at most batch_size
+// keys per call, which must be positive. The keys are sorted by the
+// comparator of the DB first, so that each batch reads neighbouring keys
+// together and coalesces their block reads.
+//
+// values and statuses are resized to one entry per key, in the order of
+// keys. batch_micros gets the latency of each MultiGet call.
+void SortedMultiGet(DB* db, const ReadOptions& read_options,
+                    const std::vector<std::string>& keys, size_t batch_size,
+                    std::vector<std::string>* values,
+                    std::vector<Status>* statuses,
+                    std::vector<uint64_t>* batch_micros);
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,21 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/predicate_compaction_filter.h"
+
+namespace rocksdb { namespace table {
+
+bool PredicateCompactionFilter::Filter(int /* level */, const Slice& key,
+                                       const Slice& /* value */,
+                                       std::string* /* new_value */,
+                                       bool* /* value_changed */) const {
+  if ((!begin_.empty() && key.compare(begin_) < 0) ||
+      (!end_.empty() && key.compare(end_) >= 0) ||
+      !range_.Matches(key)) {
+    return false;
+  }
+  removed_++;
+  return true;
+}
+
+}}  // namespace rocksdb::table
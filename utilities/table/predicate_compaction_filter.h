@@ -0,0 +1,47 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "rocksdb/compaction_filter.h"
+#include "utilities/table/key_column_range.h"
+
+namespace rocksdb { namespace table {
+
+// Drops the rows in [begin, end) whose key column lies in range as they
+// are compacted, for predicates that don't map to one contiguous key
+// range and so can't be a DeleteRange. No tombstones are written for
+// rows in the bottommost level. An empty begin or end is unbounded.
+//
+// Set it as Options::compaction_filter and compact the range to apply
+// it right away; otherwise rows go as their files are compacted.
+class PredicateCompactionFilter : public CompactionFilter {
+ public:
+  PredicateCompactionFilter(const std::string& begin, const std::string& end,
+                            const KeyColumnRange& range)
+    : begin_(begin), end_(end), range_(range), removed_(0) {}
+
+  virtual bool Filter(int level, const Slice& key, const Slice& value,
+                      std::string* new_value,
+                      bool* value_changed) const override;
+
+  virtual const char* Name() const override {
+    return "rocksdb.table.PredicateCompactionFilter";
+  }
+
+  // Rows dropped so far.
+  uint64_t removed() const { return removed_.load(); }
+
+ private:
+  const std::string begin_;
+  const std::string end_;
+  const KeyColumnRange range_;
+  // Filter is const and called from concurrent compactions.
+  mutable std::atomic<uint64_t> removed_;
+};
+
+}}  // namespace rocksdb::table
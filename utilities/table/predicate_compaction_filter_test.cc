@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/predicate_compaction_filter.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+
+std::string Int(int64_t v) {
+  std::string encoded;
+  Serialize<int64_t>(v, encoded);
+  return encoded;
+}
+
+std::string Key(int64_t leading, int64_t column) {
+  return Int(leading) + Int(column);
+}
+
+bool Filter(const CompactionFilter& filter, const std::string& key) {
+  std::string new_value;
+  bool value_changed = false;
+  bool removed = filter.Filter(1, key, "value", &new_value, &value_changed);
+  EXPECT_FALSE(value_changed);
+  return removed;
+}
+
+}  // namespace
+
+TEST(PredicateCompactionFilter, DropsMatchingRows) {
+  PredicateCompactionFilter filter(
+      "", "", KeyColumnRange({kInt}, Int(10), Int(20)));
+  EXPECT_FALSE(Filter(filter, Key(1, 9)));
+  EXPECT_TRUE(Filter(filter, Key(1, 10)));
+  EXPECT_TRUE(Filter(filter, Key(2, 20)));
+  EXPECT_FALSE(Filter(filter, Key(2, 21)));
+  // Too short to have the column.
+  EXPECT_FALSE(Filter(filter, Int(1)));
+  EXPECT_EQ(2U, filter.removed());
+}
+
+TEST(PredicateCompactionFilter, OnlyInsideKeyRange) {
+  // Rows of leading values 2 and 3 only.
+  PredicateCompactionFilter filter(
+      Int(2), Int(4), KeyColumnRange({kInt}, Int(10), Int(20)));
+  EXPECT_FALSE(Filter(filter, Key(1, 15)));
+  EXPECT_TRUE(Filter(filter, Key(2, 15)));
+  EXPECT_TRUE(Filter(filter, Key(3, 15)));
+  EXPECT_FALSE(Filter(filter, Key(3, 25)));
+  EXPECT_FALSE(Filter(filter, Key(4, 15)));
+  EXPECT_EQ(2U, filter.removed());
+
+  PredicateCompactionFilter from(
+      Int(3), "", KeyColumnRange({kInt}, Int(10), Int(20)));
+  EXPECT_FALSE(Filter(from, Key(2, 15)));
+  EXPECT_TRUE(Filter(from, Key(100, 15)));
+
+  PredicateCompactionFilter to(
+      "", Int(3), KeyColumnRange({kInt}, Int(10), Int(20)));
+  EXPECT_TRUE(Filter(to, Key(-100, 15)));
+  EXPECT_FALSE(Filter(to, Key(3, 15)));
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,232 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/row_formatter.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "rocksdb/utilities/ldb_cmd.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+void PutFixed32(uint32_t val, std::string* out) {
+  char buf[4];
+  for (int i = 0; i < 4; i++) {
+    buf[i] = static_cast<char>(val >> (8 * i));
+  }
+  out->append(buf, sizeof(buf));
+}
+
+void PutFixed64(uint64_t val, std::string* out) {
+  char buf[8];
+  for (int i = 0; i < 8; i++) {
+    buf[i] = static_cast<char>(val >> (8 * i));
+  }
+  out->append(buf, sizeof(buf));
+}
+
+void PadTo8(std::string* out) {
+  out->append((8 - out->size() % 8) % 8, '\0');
+}
+
+void AppendVector(const std::vector<Dynamic>& vec, std::string* out) {
+  bool first = true;
+  for (const auto& r : vec) {
+    if (!first) {
+      out->append(", ");
+    } else {
+      first = false;
+    }
+    out->append(r.toString());
+  }
+}
+
+class TextFormatter : public RowFormatter {
+ public:
+  explicit TextFormatter(const SchemaRegistry* schemas)
+    : schemas_(schemas) {}
+
+  virtual Status Add(const Slice& key, const Slice& value,
+                     std::string* out) override {
+    // key_ and value_ are reused across rows.
+    Status st = schemas_->DecodeRow(key, value, &key_, &value_);
+    if (st.ok()) {
+      AppendVector(key_, out);
+      out->append(DELIM);
+      AppendVector(value_, out);
+      out->append("\n");
+    }
+    return st;
+  }
+
+ private:
+  const SchemaRegistry* schemas_;
+  std::vector<Dynamic> key_;
+  std::vector<Dynamic> value_;
+};
+
+class BinaryFormatter : public RowFormatter {
+ public:
+  virtual Status Add(const Slice& key, const Slice& value,
+                     std::string* out) override {
+    PutFixed32(static_cast<uint32_t>(key.size()), out);
+    out->append(key.data(), key.size());
+    PutFixed32(static_cast<uint32_t>(value.size()), out);
+    out->append(value.data(), value.size());
+    return Status::OK();
+  }
+};
+
+// Rows are collected into batches of one schema id, like Arrow record
+// batches. A batch is, with little-endian integers:
+//
+//   "RTB1"
+//   int64   schema id
+//   uint32  rows
+//   uint32  key columns
+//   uint32  value columns
+//
+// followed by one column per key and value column:
+//
+//   uint32  Dynamic::Type of the column
+//   uint32  0
+//   uint64  size of the buffers that follow
+//   buffers int64[rows] for ints, double[rows] for doubles and
+//           uint8[rows] for bools; uint32 offsets[rows + 1] and then the
+//           bytes for strings. Each buffer is padded to 8 bytes.
+//
+// A batch ends at a change of schema id or after kBatchRows rows. Its
+// size is a multiple of 8, so buffers stay aligned in a stream of
+// batches.
+class ColumnarFormatter : public RowFormatter {
+ public:
+  explicit ColumnarFormatter(const SchemaRegistry* schemas)
+    : schemas_(schemas), schema_id_(0), key_columns_(0), rows_(0) {}
+
+  virtual Status Add(const Slice& key, const Slice& value,
+                     std::string* out) override {
+    Status st = schemas_->DecodeRow(key, value, &key_, &value_);
+    if (!st.ok()) {
+      return st;
+    }
+    int64_t id = key_[schemas_->schema_id_column()].getInt();
+    if (rows_ > 0 && (id != schema_id_ || rows_ >= kBatchRows)) {
+      Flush(out);
+    }
+    if (rows_ == 0) {
+      const CompiledSchema* compiled = schemas_->Find(id);
+      schema_id_ = id;
+      key_columns_ = compiled->schema.key.size();
+      columns_.resize(key_columns_ + compiled->schema.value.size());
+      for (size_t i = 0; i < columns_.size(); i++) {
+        columns_[i].type = i < key_columns_
+            ? compiled->schema.key[i].type
+            : compiled->schema.value[i - key_columns_].type;
+        columns_[i].values.clear();
+        columns_[i].offsets.assign(1, 0);
+      }
+    }
+    for (size_t i = 0; i < columns_.size(); i++) {
+      Append(i < key_columns_ ? key_[i] : value_[i - key_columns_],
+             &columns_[i]);
+    }
+    rows_++;
+    return Status::OK();
+  }
+
+  virtual void Flush(std::string* out) override {
+    if (rows_ == 0) {
+      return;
+    }
+    out->append("RTB1");
+    PutFixed64(static_cast<uint64_t>(schema_id_), out);
+    PutFixed32(static_cast<uint32_t>(rows_), out);
+    PutFixed32(static_cast<uint32_t>(key_columns_), out);
+    PutFixed32(static_cast<uint32_t>(columns_.size() - key_columns_), out);
+    for (auto& column : columns_) {
+      std::string buffers;
+      if (column.type == Dynamic::T_STRING ||
+          column.type == Dynamic::T_SLICE) {
+        for (uint32_t offset : column.offsets) {
+          PutFixed32(offset, &buffers);
+        }
+        PadTo8(&buffers);
+      }
+      buffers.append(column.values);
+      PadTo8(&buffers);
+      PutFixed32(static_cast<uint32_t>(column.type), out);
+      PutFixed32(0, out);
+      PutFixed64(buffers.size(), out);
+      out->append(buffers);
+    }
+    rows_ = 0;
+  }
+
+ private:
+  static const size_t kBatchRows = 64 << 10;
+
+  struct Column {
+    Dynamic::Type type;
+    // Fixed width values, or the bytes of strings.
+    std::string values;
+    // End of each string in values, after a leading 0.
+    std::vector<uint32_t> offsets;
+  };
+
+  static void Append(const Dynamic& val, Column* column) {
+    switch (column->type) {
+      case Dynamic::T_BLANK:
+        break;
+      case Dynamic::T_BOOL:
+        column->values.push_back(val.getBool() ? 1 : 0);
+        break;
+      case Dynamic::T_DOUBLE: {
+        double d = val.getDouble();
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        PutFixed64(bits, &column->values);
+        break;
+      }
+      case Dynamic::T_INT:
+        PutFixed64(static_cast<uint64_t>(val.getInt()), &column->values);
+        break;
+      case Dynamic::T_STRING:
+      case Dynamic::T_SLICE:
+        column->values.append(val.getString());
+        column->offsets.push_back(
+            static_cast<uint32_t>(column->values.size()));
+        break;
+    }
+  }
+
+  const SchemaRegistry* schemas_;
+  std::vector<Dynamic> key_;
+  std::vector<Dynamic> value_;
+  int64_t schema_id_;
+  size_t key_columns_;
+  size_t rows_;
+  std::vector<Column> columns_;
+};
+
+}  // namespace
+
+Status NewRowFormatter(const std::string& format,
+                       const SchemaRegistry* schemas,
+                       std::unique_ptr<RowFormatter>* formatter) {
+  if (format == "text") {
+    formatter->reset(new TextFormatter(schemas));
+  } else if (format == "binary") {
+    formatter->reset(new BinaryFormatter());
+  } else if (format == "columnar") {
+    formatter->reset(new ColumnarFormatter(schemas));
+  } else {
+    return Status::InvalidArgument("unknown output format", format);
+  }
+  return Status::OK();
+}
+
+}}  // namespace rocksdb::table
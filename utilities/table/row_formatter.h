@@ -0,0 +1,45 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "utilities/table/schema_registry.h"
+
+namespace rocksdb { namespace table {
+
+// Formats the encoded rows of a scan for output. The formats are:
+//
+//   text      "<key columns> ==> <value columns>" lines, as tput takes
+//             them.
+//   binary    the encoded rows as they are stored, each a little-endian
+//             uint32 key size, the key, a uint32 value size and the
+//             value. Nothing is decoded.
+//   columnar  batches of rows of one schema, each column in a typed
+//             buffer; see ColumnarFormatter in row_formatter.cc.
+//
+// The output of separate formatters can be concatenated, so partitions
+// of a scan are formatted independently.
+class RowFormatter {
+ public:
+  virtual ~RowFormatter() {}
+
+  // Append the row to out, or keep it to be appended by a later call.
+  virtual Status Add(const Slice& key, const Slice& value,
+                     std::string* out) = 0;
+
+  // Append the rows kept so far to out.
+  virtual void Flush(std::string* /* out */) {}
+};
+
+// A formatter for format, one of text, binary and columnar. Rows are
+// decoded with schemas, which must outlive the formatter.
+Status NewRowFormatter(const std::string& format,
+                       const SchemaRegistry* schemas,
+                       std::unique_ptr<RowFormatter>* formatter);
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,337 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/schema_registry.h"
+
+#include <algorithm>
+#include <set>
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+// The schema id column is an ascending fixed width int.
+const ColumnSpec kSchemaIdColumn = {
+  Dynamic::T_INT, false, ColumnEncoding::kDefault, 0
+};
+
+bool SameSpec(const ColumnSpec& a, const ColumnSpec& b) {
+  return a.type == b.type && a.descending == b.descending &&
+         a.encoding == b.encoding && a.width == b.width &&
+         a.dictionary == b.dictionary;
+}
+
+std::vector<ColumnDecoder> DecodersFor(const std::vector<ColumnSpec>& specs) {
+  std::vector<ColumnDecoder> decoders;
+  decoders.reserve(specs.size());
+  for (const auto& spec : specs) {
+    decoders.push_back(DecoderFor(spec));
+  }
+  return decoders;
+}
+
+}  // namespace
+
+SchemaRegistry::SchemaRegistry(size_t schema_id_column)
+  : schema_id_column_(schema_id_column), has_ttl_(false),
+    has_zone_maps_(false),
+    has_indexes_(false) {}
+
+Status SchemaRegistry::Add(int64_t id, const TableSchema& schema) {
+  std::set<int64_t> ids = {id};
+  for (const auto& index : schema.indexes) {
+    if (!ids.insert(index.id).second || index.columns.empty()) {
+      return Status::InvalidArgument(
+          "schema " + std::to_string(id),
+          "an index needs columns and an id of its own");
+    }
+    for (const auto& ref : index.columns) {
+      const auto& columns = ref.value ? schema.value : schema.key;
+      if (ref.n < 0 || static_cast<size_t>(ref.n) >= columns.size()) {
+        return Status::InvalidArgument(
+            "schema " + std::to_string(id),
+            "index " + std::to_string(index.id) + " has no column " +
+            (ref.value ? "v" : "") + std::to_string(ref.n));
+      }
+    }
+  }
+  for (int64_t taken : ids) {
+    const CompiledSchema* existing = Find(taken);
+    if (existing != nullptr && existing->table_id != id) {
+      return Status::InvalidArgument(
+          "schema " + std::to_string(id),
+          "id " + std::to_string(taken) + " is taken by " +
+          (existing->primary_key_column == 0 ? "table " : "an index of ") +
+          std::to_string(existing->table_id));
+    }
+  }
+  Status st = AddCompiled(id, schema, 0, id);
+  for (size_t i = 0; st.ok() && i < schema.indexes.size(); i++) {
+    const IndexSpec& index = schema.indexes[i];
+    st = AddCompiled(index.id, IndexSchema(schema, index),
+                     schema_id_column_ + 1 + index.columns.size(), id);
+    has_indexes_ = true;
+  }
+  return st;
+}
+
+TableSchema SchemaRegistry::IndexSchema(const TableSchema& table,
+                                        const IndexSpec& index) const {
+  TableSchema schema;
+  schema.key.assign(table.key.begin(),
+                    table.key.begin() + schema_id_column_);
+  schema.key.push_back(kSchemaIdColumn);
+  for (const auto& ref : index.columns) {
+    schema.key.push_back(ref.value ? table.value[ref.n] : table.key[ref.n]);
+  }
+  size_t primary_key_column = schema.key.size();
+  schema.key.insert(schema.key.end(), table.key.begin(), table.key.end());
+  // Entries expire with their rows.
+  if (table.ttl_column >= 0) {
+    schema.ttl_column =
+        static_cast<int>(primary_key_column) + table.ttl_column;
+    schema.retention = table.retention;
+  }
+  return schema;
+}
+
+Status SchemaRegistry::AddCompiled(int64_t id, const TableSchema& schema,
+                                   size_t primary_key_column,
+                                   int64_t table_id) {
+  const std::string name = "schema " + std::to_string(id);
+  if (schema.key.size() <= schema_id_column_ ||
+      !SameSpec(schema.key[schema_id_column_], kSchemaIdColumn)) {
+    return Status::InvalidArgument(
+        name, "key column " + std::to_string(schema_id_column_) +
+              " must be the schema id, an ascending int");
+  }
+  if (schema.ttl_column >= 0) {
+    if (static_cast<size_t>(schema.ttl_column) >= schema.key.size() ||
+        schema.key[schema.ttl_column].type != Dynamic::T_INT) {
+      return Status::InvalidArgument(
+          name, "ttl_column must be an int key column");
+    }
+    if (schema.retention <= 0) {
+      return Status::InvalidArgument(name, "retention must be positive");
+    }
+  }
+  for (int column : schema.zone_map_columns) {
+    if (column < 0 || static_cast<size_t>(column) >= schema.key.size()) {
+      return Status::InvalidArgument(
+          name, "zone_map " + std::to_string(column) +
+                " is not a key column");
+    }
+  }
+  std::vector<ColumnSpec> prefix(schema.key.begin(),
+                                 schema.key.begin() + schema_id_column_);
+  if (schemas_.empty()) {
+    prefix_ = prefix;
+    prefix_decoders_ = DecodersFor(prefix_);
+  } else {
+    for (size_t i = 0; i < prefix.size(); i++) {
+      if (!SameSpec(prefix[i], prefix_[i])) {
+        return Status::InvalidArgument(
+            name, "the columns before the schema id differ from other "
+                  "schemas");
+      }
+    }
+  }
+
+  CompiledSchema compiled = {id, schema, DecodersFor(schema.key),
+                             DecodersFor(schema.value), primary_key_column,
+                             table_id};
+  auto& zone_map_columns = compiled.schema.zone_map_columns;
+  std::sort(zone_map_columns.begin(), zone_map_columns.end());
+  zone_map_columns.erase(
+      std::unique(zone_map_columns.begin(), zone_map_columns.end()),
+      zone_map_columns.end());
+  has_ttl_ = has_ttl_ || schema.ttl_column >= 0;
+  has_zone_maps_ = has_zone_maps_ || !zone_map_columns.empty();
+  const CompiledSchema* existing = Find(id);
+  if (existing != nullptr) {
+    schemas_[existing - schemas_.data()] = std::move(compiled);
+    return Status::OK();
+  }
+  int32_t index = static_cast<int32_t>(schemas_.size());
+  schemas_.push_back(std::move(compiled));
+  if (id >= 0 && id < kMaxDenseId) {
+    if (dense_.size() <= static_cast<size_t>(id)) {
+      dense_.resize(id + 1, -1);
+    }
+    dense_[id] = index;
+  } else {
+    sparse_[id] = index;
+  }
+  return Status::OK();
+}
+
+Status SchemaRegistry::KeyPrefix(size_t n,
+                                 std::vector<ColumnSpec>* columns) const {
+  columns->clear();
+  if (schemas_.empty()) {
+    return Status::InvalidArgument("no schemas to take key columns from");
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (i < prefix_.size()) {
+      columns->push_back(prefix_[i]);
+      continue;
+    }
+    if (i == schema_id_column_) {
+      columns->push_back(kSchemaIdColumn);
+      continue;
+    }
+    // Past the schema id, the schemas have to agree column by column.
+    for (const auto& compiled : schemas_) {
+      const auto& key = compiled.schema.key;
+      if (key.size() <= i) {
+        return Status::InvalidArgument(
+            "schema " + std::to_string(compiled.id) + " has fewer than " +
+            std::to_string(n) + " key columns");
+      }
+      if (columns->size() == i) {
+        columns->push_back(key[i]);
+      } else if (!SameSpec(key[i], columns->back())) {
+        return Status::InvalidArgument(
+            "key column " + std::to_string(i) + " differs between schemas");
+      }
+    }
+  }
+  return Status::OK();
+}
+
+size_t SchemaRegistry::FixedKeyLength() const {
+  size_t length = 0;
+  for (const auto& compiled : schemas_) {
+    size_t n = FixedLength(compiled.schema.key);
+    if (n == 0 || (length != 0 && n != length)) {
+      return 0;
+    }
+    length = n;
+  }
+  return length;
+}
+
+Status SchemaRegistry::DecodeSchemaId(const Slice& key, int64_t* id) const {
+  Slice in = key;
+  Dynamic val;
+  Status st;
+  for (size_t i = 0; st.ok() && i < prefix_decoders_.size(); i++) {
+    st = prefix_decoders_[i](prefix_[i], &in, &val);
+  }
+  if (st.ok()) {
+    st = DecodeColumn(kSchemaIdColumn, &in, &val);
+  }
+  if (st.ok()) {
+    *id = val.getInt();
+  }
+  return st;
+}
+
+Status SchemaRegistry::IndexKeys(const Slice& key, const Slice& value,
+                                 std::vector<std::string>* index_keys) const {
+  int64_t id;
+  if (!has_indexes_ || !DecodeSchemaId(key, &id).ok()) {
+    return Status::OK();
+  }
+  const CompiledSchema* compiled = Find(id);
+  if (compiled == nullptr || compiled->schema.indexes.empty()) {
+    return Status::OK();
+  }
+
+  // The encoded key columns, then the value columns.
+  const TableSchema& schema = compiled->schema;
+  std::vector<Slice> columns;
+  columns.reserve(schema.key.size() + schema.value.size());
+  Slice in = key;
+  for (size_t i = 0; i < schema.key.size() + schema.value.size(); i++) {
+    if (i == schema.key.size()) {
+      in = value;
+    }
+    const ColumnSpec& spec = i < schema.key.size()
+        ? schema.key[i] : schema.value[i - schema.key.size()];
+    const char* start = in.data();
+    if (!SkipColumn(spec, &in)) {
+      return Status::Corruption("truncated row of " + std::to_string(id));
+    }
+    columns.push_back(Slice(start, in.data() - start));
+  }
+
+  const Slice prefix(key.data(), columns[schema_id_column_].data() -
+                                 key.data());
+  for (const auto& index : schema.indexes) {
+    index_keys->emplace_back(prefix.data(), prefix.size());
+    std::string* out = &index_keys->back();
+    Serialize<int64_t>(index.id, *out);
+    for (const auto& ref : index.columns) {
+      const Slice& column =
+          columns[ref.value ? schema.key.size() + ref.n : ref.n];
+      out->append(column.data(), column.size());
+    }
+    out->append(key.data(), key.size());
+  }
+  return Status::OK();
+}
+
+Status SchemaRegistry::IndexedKey(const Slice& index_key,
+                                  Slice* primary_key) const {
+  int64_t id;
+  Status st = DecodeSchemaId(index_key, &id);
+  if (!st.ok()) {
+    return st;
+  }
+  const CompiledSchema* compiled = Find(id);
+  if (compiled == nullptr || compiled->primary_key_column == 0) {
+    return Status::InvalidArgument("not an index entry");
+  }
+  Slice in = index_key;
+  for (size_t i = 0; i < compiled->primary_key_column; i++) {
+    if (!SkipColumn(compiled->schema.key[i], &in)) {
+      return Status::Corruption("truncated index entry");
+    }
+  }
+  *primary_key = in;
+  return Status::OK();
+}
+
+Status SchemaRegistry::DecodeRow(const Slice& key, const Slice& value,
+                                 std::vector<Dynamic>* key_cols,
+                                 std::vector<Dynamic>* value_cols) const {
+  // Decode up to the schema id with the shared prefix decoders, then the
+  // rest of the row with the plan of its schema.
+  Slice in = key;
+  key_cols->resize(schema_id_column_ + 1);
+  Status st;
+  for (size_t i = 0; st.ok() && i < prefix_decoders_.size(); i++) {
+    st = prefix_decoders_[i](prefix_[i], &in, &(*key_cols)[i]);
+  }
+  if (st.ok()) {
+    st = DecodeColumn(kSchemaIdColumn, &in, &(*key_cols)[schema_id_column_]);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+  int64_t id = (*key_cols)[schema_id_column_].getInt();
+  const CompiledSchema* compiled = Find(id);
+  if (compiled == nullptr) {
+    return Status::NotFound("no schema for id", std::to_string(id));
+  }
+
+  const TableSchema& schema = compiled->schema;
+  const auto& key_decoders = compiled->key_decoders;
+  key_cols->resize(key_decoders.size());
+  for (size_t i = schema_id_column_ + 1;
+       st.ok() && i < key_decoders.size(); i++) {
+    st = key_decoders[i](schema.key[i], &in, &(*key_cols)[i]);
+  }
+  const auto& value_decoders = compiled->value_decoders;
+  value_cols->resize(value_decoders.size());
+  in = value;
+  for (size_t i = 0; st.ok() && i < value_decoders.size(); i++) {
+    st = value_decoders[i](schema.value[i], &in, &(*value_cols)[i]);
+  }
+  return st;
+}
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,123 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "utilities/table/table_schema.h"
+
+namespace rocksdb { namespace table {
+
+// A schema compiled into a decoding plan: the decoder of every column,
+// looked up once when the schema is added.
+struct CompiledSchema {
+  int64_t id;
+  TableSchema schema;
+  std::vector<ColumnDecoder> key_decoders;
+  std::vector<ColumnDecoder> value_decoders;
+  // For the schema of an index, the key columns before the primary key
+  // of the row. 0 for tables.
+  size_t primary_key_column;
+  // The id of the table: id itself, or the table an index belongs to.
+  int64_t table_id;
+};
+
+// The schemas of a DB, indexed by schema id.
+//
+// The schema id is the key column at schema_id_column, an ascending int.
+// With the default of 0 every table is a contiguous key range (the
+// relational layout). With 1, keys start with an entity id followed by
+// the schema id, so the rows of one entity are clustered across tables
+// (the hierarchical layout). The columns before the schema id must have
+// the same spec in every schema, since they are decoded before the
+// schema is known.
+class SchemaRegistry {
+ public:
+  explicit SchemaRegistry(size_t schema_id_column = 0);
+
+  size_t schema_id_column() const { return schema_id_column_; }
+  bool empty() const { return schemas_.empty(); }
+  // Some schema has a ttl_column.
+  bool has_ttl() const { return has_ttl_; }
+  // Some schema has zone_map_columns.
+  bool has_zone_maps() const { return has_zone_maps_; }
+
+  // Compile and add the schema of id, replacing an earlier one. Fails if
+  // its leading columns don't fit schema_id_column. The entries of each
+  // of its indexes get a schema too, under the id of the index. Every id
+  // names one schema: a table replaces only itself and its own indexes,
+  // so ids taken by another table or its indexes are rejected.
+  Status Add(int64_t id, const TableSchema& schema);
+
+  // nullptr if id has no schema.
+  const CompiledSchema* Find(int64_t id) const {
+    int32_t index = -1;
+    if (id >= 0 && id < static_cast<int64_t>(dense_.size())) {
+      index = dense_[id];
+    } else {
+      auto it = sparse_.find(id);
+      if (it != sparse_.end()) {
+        index = it->second;
+      }
+    }
+    return index < 0 ? nullptr : &schemas_[index];
+  }
+
+  // The specs of the first n key columns, which must be the same in
+  // every schema. They are the prefix_extractor columns of the DB.
+  Status KeyPrefix(size_t n, std::vector<ColumnSpec>* columns) const;
+
+  // The length of every key if all schemas have fixed width keys of the
+  // same length, otherwise 0. Index entries count too.
+  size_t FixedKeyLength() const;
+
+  // Decode the schema id column of an encoded key.
+  Status DecodeSchemaId(const Slice& key, int64_t* id) const;
+
+  // Append the keys of the index entries of an encoded row to
+  // index_keys. They are built from the encoded columns, without
+  // decoding. Rows without a schema or indexes have none.
+  Status IndexKeys(const Slice& key, const Slice& value,
+                   std::vector<std::string>* index_keys) const;
+
+  // The primary key of the row an index entry points to, a suffix of
+  // index_key.
+  Status IndexedKey(const Slice& index_key, Slice* primary_key) const;
+
+  // Decode a row with the schema of its key. The vectors are resized to
+  // the columns of the schema, so passing the same ones for every row
+  // reuses their memory.
+  Status DecodeRow(const Slice& key, const Slice& value,
+                   std::vector<Dynamic>* key_cols,
+                   std::vector<Dynamic>* value_cols) const;
+
+ private:
+  // Ids below this are looked up in dense_, others in sparse_.
+  static const int64_t kMaxDenseId = 1 << 16;
+
+  Status AddCompiled(int64_t id, const TableSchema& schema,
+                     size_t primary_key_column, int64_t table_id);
+  // The schema of the entries of index of a table.
+  TableSchema IndexSchema(const TableSchema& table,
+                          const IndexSpec& index) const;
+
+  size_t schema_id_column_;
+  // Specs and decoders of the columns before the schema id.
+  std::vector<ColumnSpec> prefix_;
+  std::vector<ColumnDecoder> prefix_decoders_;
+  std::vector<CompiledSchema> schemas_;
+  bool has_ttl_;
+  bool has_zone_maps_;
+  bool has_indexes_;
+  // Index into schemas_ by schema id, -1 for ids without a schema.
+  std::vector<int32_t> dense_;
+  std::map<int64_t, int32_t> sparse_;
+};
+
+}}  // namespace rocksdb::table
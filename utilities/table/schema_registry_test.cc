@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/schema_registry.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+const ColumnSpec kVarint = {Dynamic::T_INT, false, ColumnEncoding::kVarint,
+                            0};
+const ColumnSpec kString = {Dynamic::T_STRING, false,
+                            ColumnEncoding::kDefault, 0};
+const ColumnSpec kDescString = {Dynamic::T_STRING, true,
+                                ColumnEncoding::kDefault, 0};
+const ColumnSpec kDouble = {Dynamic::T_DOUBLE, false,
+                            ColumnEncoding::kDefault, 0};
+
+TableSchema Schema(const std::vector<ColumnSpec>& key,
+                   const std::vector<ColumnSpec>& value) {
+  TableSchema schema;
+  schema.key = key;
+  schema.value = value;
+  return schema;
+}
+
+}  // namespace
+
+TEST(SchemaRegistry, FindDenseAndSparseIds) {
+  SchemaRegistry registry;
+  EXPECT_TRUE(registry.empty());
+  ASSERT_TRUE(registry.Add(1, Schema({kInt, kString}, {kInt})).ok());
+  ASSERT_TRUE(registry.Add(1 << 20, Schema({kInt}, {})).ok());
+  ASSERT_TRUE(registry.Add(-5, Schema({kInt, kInt}, {})).ok());
+  EXPECT_FALSE(registry.empty());
+
+  ASSERT_NE(nullptr, registry.Find(1));
+  EXPECT_EQ(1, registry.Find(1)->id);
+  EXPECT_EQ(2U, registry.Find(1)->key_decoders.size());
+  EXPECT_EQ(1U, registry.Find(1)->value_decoders.size());
+  ASSERT_NE(nullptr, registry.Find(1 << 20));
+  EXPECT_EQ(1 << 20, registry.Find(1 << 20)->id);
+  ASSERT_NE(nullptr, registry.Find(-5));
+  EXPECT_EQ(-5, registry.Find(-5)->id);
+  EXPECT_EQ(nullptr, registry.Find(0));
+  EXPECT_EQ(nullptr, registry.Find(2));
+  EXPECT_EQ(nullptr, registry.Find(1 << 21));
+}
+
+TEST(SchemaRegistry, AddReplacesSchema) {
+  SchemaRegistry registry;
+  ASSERT_TRUE(registry.Add(3, Schema({kInt, kString}, {})).ok());
+  ASSERT_TRUE(registry.Add(3, Schema({kInt, kDouble}, {kInt})).ok());
+  const CompiledSchema* compiled = registry.Find(3);
+  ASSERT_NE(nullptr, compiled);
+  EXPECT_EQ(Dynamic::T_DOUBLE, compiled->schema.key[1].type);
+  EXPECT_EQ(1U, compiled->schema.value.size());
+}
+
+TEST(SchemaRegistry, AddRejectsBadSchemaIdColumn) {
+  SchemaRegistry registry;
+  // Too short, and not an ascending fixed width int.
+  EXPECT_TRUE(registry.Add(1, Schema({}, {kInt})).IsInvalidArgument());
+  EXPECT_TRUE(registry.Add(1, Schema({kString}, {})).IsInvalidArgument());
+  EXPECT_TRUE(registry.Add(1, Schema({kVarint}, {})).IsInvalidArgument());
+  ColumnSpec desc = kInt;
+  desc.descending = true;
+  EXPECT_TRUE(registry.Add(1, Schema({desc}, {})).IsInvalidArgument());
+  EXPECT_TRUE(registry.empty());
+
+  SchemaRegistry hierarchical(1);
+  EXPECT_EQ(1U, hierarchical.schema_id_column());
+  EXPECT_TRUE(hierarchical.Add(1, Schema({kInt}, {})).IsInvalidArgument());
+  ASSERT_TRUE(hierarchical.Add(1, Schema({kString, kInt}, {})).ok());
+  // The columns before the schema id must be the same in every schema.
+  EXPECT_TRUE(
+      hierarchical.Add(2, Schema({kInt, kInt}, {})).IsInvalidArgument());
+  EXPECT_TRUE(hierarchical.Add(2, Schema({kString, kInt, kInt}, {})).ok());
+}
+
+TEST(SchemaRegistry, AddChecksTtlAndZoneMapColumns) {
+  SchemaRegistry registry;
+  TableSchema schema = Schema({kInt, kString, kInt}, {});
+  schema.ttl_column = 1;
+  schema.retention = 10;
+  EXPECT_TRUE(registry.Add(1, schema).IsInvalidArgument());
+  schema.ttl_column = 2;
+  schema.retention = 0;
+  EXPECT_TRUE(registry.Add(1, schema).IsInvalidArgument());
+  schema.retention = 10;
+  ASSERT_TRUE(registry.Add(1, schema).ok());
+  EXPECT_TRUE(registry.has_ttl());
+  EXPECT_FALSE(registry.has_zone_maps());
+
+  TableSchema zoned = Schema({kInt, kString, kInt}, {});
+  zoned.zone_map_columns = {3};
+  EXPECT_TRUE(registry.Add(2, zoned).IsInvalidArgument());
+  zoned.zone_map_columns = {2, 1, 2};
+  ASSERT_TRUE(registry.Add(2, zoned).ok());
+  EXPECT_TRUE(registry.has_zone_maps());
+  EXPECT_EQ(std::vector<int>({1, 2}),
+            registry.Find(2)->schema.zone_map_columns);
+}
+
+TEST(SchemaRegistry, KeyPrefix) {
+  SchemaRegistry registry(1);
+  std::vector<ColumnSpec> columns;
+  EXPECT_TRUE(registry.KeyPrefix(1, &columns).IsInvalidArgument());
+
+  ASSERT_TRUE(registry.Add(1, Schema({kString, kInt, kInt, kString}, {}))
+                  .ok());
+  ASSERT_TRUE(registry.Add(2, Schema({kString, kInt, kInt, kDouble}, {}))
+                  .ok());
+  ASSERT_TRUE(registry.KeyPrefix(3, &columns).ok());
+  ASSERT_EQ(3U, columns.size());
+  EXPECT_EQ(Dynamic::T_STRING, columns[0].type);
+  EXPECT_EQ(Dynamic::T_INT, columns[1].type);
+  EXPECT_EQ(Dynamic::T_INT, columns[2].type);
+  // The schemas disagree on the fourth column.
+  EXPECT_TRUE(registry.KeyPrefix(4, &columns).IsInvalidArgument());
+
+  ASSERT_TRUE(registry.Add(3, Schema({kString, kInt}, {})).ok());
+  EXPECT_TRUE(registry.KeyPrefix(2, &columns).ok());
+  EXPECT_TRUE(registry.KeyPrefix(3, &columns).IsInvalidArgument());
+}
+
+TEST(SchemaRegistry, FixedKeyLength) {
+  SchemaRegistry registry;
+  EXPECT_EQ(0U, registry.FixedKeyLength());
+  ASSERT_TRUE(registry.Add(1, Schema({kInt, kInt}, {kString})).ok());
+  EXPECT_EQ(16U, registry.FixedKeyLength());
+  ASSERT_TRUE(registry.Add(2, Schema({kInt, kDouble}, {})).ok());
+  EXPECT_EQ(16U, registry.FixedKeyLength());
+  ASSERT_TRUE(registry.Add(3, Schema({kInt}, {})).ok());
+  EXPECT_EQ(0U, registry.FixedKeyLength());
+
+  SchemaRegistry strings;
+  ASSERT_TRUE(strings.Add(1, Schema({kInt, kString}, {})).ok());
+  EXPECT_EQ(0U, strings.FixedKeyLength());
+}
+
+TEST(SchemaRegistry, DecodeRow) {
+  SchemaRegistry registry(1);
+  ASSERT_TRUE(
+      registry.Add(2, Schema({kInt, kInt, kDescString}, {kDouble})).ok());
+
+  std::string key;
+  std::string value;
+  Serialize<int64_t>(7, key);
+  Serialize<int64_t>(2, key);
+  SerializeDescending<std::string>("ab", key);
+  Serialize<double>(1.5, value);
+
+  int64_t id;
+  ASSERT_TRUE(registry.DecodeSchemaId(key, &id).ok());
+  EXPECT_EQ(2, id);
+
+  std::vector<Dynamic> key_cols;
+  std::vector<Dynamic> value_cols;
+  ASSERT_TRUE(registry.DecodeRow(key, value, &key_cols, &value_cols).ok());
+  ASSERT_EQ(3U, key_cols.size());
+  EXPECT_EQ(7, key_cols[0].getInt());
+  EXPECT_EQ(2, key_cols[1].getInt());
+  EXPECT_EQ("ab", key_cols[2].getString());
+  ASSERT_EQ(1U, value_cols.size());
+  EXPECT_EQ(1.5, value_cols[0].getDouble());
+
+  std::string other;
+  Serialize<int64_t>(7, other);
+  Serialize<int64_t>(5, other);
+  EXPECT_TRUE(
+      registry.DecodeRow(other, "", &key_cols, &value_cols).IsNotFound());
+}
+
+TEST(SchemaRegistry, IndexIdsMustNotCollide) {
+  TableSchema table = Schema({kInt, kInt}, {kString});
+  table.indexes = {IndexSpec{10, {ColumnRef{true, 0}}}};
+
+  // The index id is another table's id.
+  SchemaRegistry registry;
+  ASSERT_TRUE(registry.Add(10, Schema({kInt, kInt}, {})).ok());
+  EXPECT_TRUE(registry.Add(1, table).IsInvalidArgument());
+  EXPECT_EQ(nullptr, registry.Find(1));
+  EXPECT_EQ(0U, registry.Find(10)->primary_key_column);
+
+  // The table id is another table's index id.
+  SchemaRegistry reversed;
+  ASSERT_TRUE(reversed.Add(1, table).ok());
+  EXPECT_TRUE(reversed.Add(10, Schema({kInt, kInt}, {})).IsInvalidArgument());
+  EXPECT_NE(0U, reversed.Find(10)->primary_key_column);
+
+  // Two tables with the same index id.
+  TableSchema other = table;
+  EXPECT_TRUE(reversed.Add(2, other).IsInvalidArgument());
+  EXPECT_EQ(nullptr, reversed.Find(2));
+  EXPECT_EQ(1, reversed.Find(10)->table_id);
+
+  // The same index twice, or the index under the table's own id.
+  other.indexes.push_back(other.indexes[0]);
+  EXPECT_TRUE(reversed.Add(3, other).IsInvalidArgument());
+  other.indexes = {IndexSpec{3, {ColumnRef{true, 0}}}};
+  EXPECT_TRUE(reversed.Add(3, other).IsInvalidArgument());
+
+  // A table may replace itself and its indexes.
+  table.indexes[0].columns = {ColumnRef{false, 1}};
+  ASSERT_TRUE(reversed.Add(1, table).ok());
+  EXPECT_EQ(Dynamic::T_INT, reversed.Find(10)->schema.key[1].type);
+}
+
+TEST(SchemaRegistry, IndexKeys) {
+  SchemaRegistry registry(1);
+  TableSchema table = Schema({kInt, kInt, kString}, {kDouble, kString});
+  table.indexes = {IndexSpec{7, {ColumnRef{true, 1}}},
+                   IndexSpec{8, {ColumnRef{true, 0}, ColumnRef{false, 2}}}};
+  ASSERT_TRUE(registry.Add(2, table).ok());
+  ASSERT_TRUE(registry.Add(3, Schema({kInt, kInt}, {kString})).ok());
+
+  std::string key;
+  Serialize<int64_t>(100, key);
+  Serialize<int64_t>(2, key);
+  Serialize<std::string>("pk", key);
+  std::string value;
+  Serialize<double>(2.5, value);
+  Serialize<std::string>("name", value);
+
+  std::vector<std::string> index_keys;
+  ASSERT_TRUE(registry.IndexKeys(key, value, &index_keys).ok());
+  ASSERT_EQ(2U, index_keys.size());
+  // <entity> <index id> <columns> <primary key>
+  std::string by_name;
+  Serialize<int64_t>(100, by_name);
+  Serialize<int64_t>(7, by_name);
+  Serialize<std::string>("name", by_name);
+  EXPECT_EQ(by_name + key, index_keys[0]);
+  std::string by_double;
+  Serialize<int64_t>(100, by_double);
+  Serialize<int64_t>(8, by_double);
+  Serialize<double>(2.5, by_double);
+  Serialize<std::string>("pk", by_double);
+  EXPECT_EQ(by_double + key, index_keys[1]);
+
+  Slice primary_key;
+  for (const auto& index_key : index_keys) {
+    ASSERT_TRUE(registry.IndexedKey(index_key, &primary_key).ok());
+    EXPECT_EQ(key, primary_key.ToString());
+  }
+  // The entries decode with the schema of their index.
+  std::vector<Dynamic> key_cols;
+  std::vector<Dynamic> value_cols;
+  ASSERT_TRUE(
+      registry.DecodeRow(index_keys[0], "", &key_cols, &value_cols).ok());
+  ASSERT_EQ(6U, key_cols.size());
+  EXPECT_EQ(7, key_cols[1].getInt());
+  EXPECT_EQ("name", key_cols[2].getString());
+  EXPECT_EQ("pk", key_cols[5].getString());
+
+  // Rows of tables without indexes have no entries, and rows aren't
+  // index entries.
+  std::string plain;
+  Serialize<int64_t>(100, plain);
+  Serialize<int64_t>(3, plain);
+  index_keys.clear();
+  ASSERT_TRUE(registry.IndexKeys(plain, value, &index_keys).ok());
+  EXPECT_TRUE(index_keys.empty());
+  EXPECT_TRUE(registry.IndexedKey(key, &primary_key).IsInvalidArgument());
+  EXPECT_TRUE(registry.IndexedKey(plain, &primary_key).IsInvalidArgument());
+
+  // A value cut inside an indexed column, and an entry cut inside the
+  // indexed columns.
+  EXPECT_TRUE(registry.IndexKeys(key, value.substr(0, value.size() - 1),
+                                 &index_keys)
+                  .IsCorruption());
+  EXPECT_TRUE(
+      registry.IndexedKey(by_name.substr(0, by_name.size() - 1), &primary_key)
+          .IsCorruption());
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+// Compares the per-value Serialize/Deserialize templates with the batch
+// API on columns of int64_t and double.
+//
+//   serialize_bench [num_values] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace {
+
+template<typename F>
+double TimeIt(int iterations, F f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         iterations;
+}
+
+template<typename T>
+void Bench(const char* name, const std::vector<T>& vals, int iterations) {
+  std::string out;
+  out.reserve(vals.size() * sizeof(T));
+  std::vector<T> decoded(vals.size());
+
+  double encode_one = TimeIt(iterations, [&]() {
+    out.clear();
+    for (auto v : vals) {
+      Serialize<T>(v, out);
+    }
+  });
+  double encode_batch = TimeIt(iterations, [&]() {
+    out.clear();
+    SerializeBatch(vals.data(), vals.size(), out);
+  });
+  double decode_one = TimeIt(iterations, [&]() {
+    rocksdb::Slice in(out);
+    for (auto& v : decoded) {
+      v = Deserialize<T>(in);
+    }
+  });
+  double decode_batch = TimeIt(iterations, [&]() {
+    rocksdb::Slice in(out);
+    DeserializeBatch(in, decoded.data(), decoded.size());
+  });
+
+  if (decoded != vals) {
+    fprintf(stderr, "%s: decoded values do not match\n", name);
+    exit(1);
+  }
+  fprintf(stdout, "%-8s encode %8.3f ms -> %8.3f ms (%.1fx)\n", name,
+          encode_one, encode_batch, encode_one / encode_batch);
+  fprintf(stdout, "%-8s decode %8.3f ms -> %8.3f ms (%.1fx)\n", name,
+          decode_one, decode_batch, decode_one / decode_batch);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t num_values = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+  int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+  std::mt19937_64 rng(301);
+  std::vector<int64_t> ints(num_values);
+  std::vector<double> doubles(num_values);
+  std::uniform_real_distribution<double> dist(-1e9, 1e9);
+  for (size_t i = 0; i < num_values; i++) {
+    ints[i] = (int64_t) rng();
+    doubles[i] = dist(rng);
+  }
+
+  fprintf(stdout, "%zu values, per-value -> batch, average of %d runs\n",
+          num_values, iterations);
+  Bench("int64", ints, iterations);
+  Bench("double", doubles, iterations);
+  return 0;
+}
@@ -1,3 +1,236 @@
 #include "rocksdb/utilities/serialize.h"
 
+#include <assert.h>
+#include <string.h>
 
+#ifdef __SSE4_2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const uint64_t kSignBit = 1UL << 63;
+
+// Scalar kernels. These are also used for the tail of a batch that does
+// not fill a whole vector.
+void EncodeInt64Scalar(const int64_t* vals, size_t n, char* dst) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t v = htobe64((uint64_t) vals[i] ^ kSignBit);
+    memcpy(dst + i * sizeof(v), &v, sizeof(v));
+  }
+}
+
+void DecodeInt64Scalar(const char* src, size_t n, int64_t* vals) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t v;
+    memcpy(&v, src + i * sizeof(v), sizeof(v));
+    vals[i] = (int64_t) (be64toh(v) ^ kSignBit);
+  }
+}
+
+void EncodeDoubleScalar(const double* vals, size_t n, char* dst) {
+  for (size_t i = 0; i < n; i++) {
+    const double d = vals[i] == 0 ? 0.0 : vals[i];
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    v ^= d >= 0 ? kSignBit : ~0UL;
+    v = htobe64(v);
+    memcpy(dst + i * sizeof(v), &v, sizeof(v));
+  }
+}
+
+void DecodeDoubleScalar(const char* src, size_t n, double* vals) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t v;
+    memcpy(&v, src + i * sizeof(v), sizeof(v));
+    v = be64toh(v);
+    v ^= (v & kSignBit) ? kSignBit : ~0UL;
+    memcpy(&vals[i], &v, sizeof(v));
+  }
+}
+
+#ifdef __SSE4_2__
+
+// Reverses the bytes of each 64 bit lane.
+inline __m128i ByteSwap64(__m128i v) {
+  const __m128i shuffle = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15,
+                                       0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm_shuffle_epi8(v, shuffle);
+}
+
+void EncodeInt64SSE(const int64_t* vals, size_t n, char* dst) {
+  const __m128i sign = _mm_set1_epi64x(kSignBit);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (vals + i));
+    v = ByteSwap64(_mm_xor_si128(v, sign));
+    _mm_storeu_si128((__m128i*) (dst + i * sizeof(int64_t)), v);
+  }
+  EncodeInt64Scalar(vals + i, n - i, dst + i * sizeof(int64_t));
+}
+
+void DecodeInt64SSE(const char* src, size_t n, int64_t* vals) {
+  const __m128i sign = _mm_set1_epi64x(kSignBit);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (src + i * sizeof(int64_t)));
+    v = _mm_xor_si128(ByteSwap64(v), sign);
+    _mm_storeu_si128((__m128i*) (vals + i), v);
+  }
+  DecodeInt64Scalar(src + i * sizeof(int64_t), n - i, vals + i);
+}
+
+void EncodeDoubleSSE(const double* vals, size_t n, char* dst) {
+  const __m128i sign = _mm_set1_epi64x(kSignBit);
+  const __m128d zero = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    // Adding 0.0 turns -0.0 into 0.0 and leaves other values alone.
+    __m128d d = _mm_add_pd(_mm_loadu_pd(vals + i), zero);
+    // mask is the sign bit for values >= 0 and all ones otherwise,
+    // including NaN, exactly like Serialize<double>.
+    __m128i ge = _mm_castpd_si128(_mm_cmpge_pd(d, zero));
+    __m128i mask = _mm_or_si128(sign, _mm_xor_si128(ge, _mm_set1_epi8(-1)));
+    __m128i v = ByteSwap64(_mm_xor_si128(_mm_castpd_si128(d), mask));
+    _mm_storeu_si128((__m128i*) (dst + i * sizeof(double)), v);
+  }
+  EncodeDoubleScalar(vals + i, n - i, dst + i * sizeof(double));
+}
+
+void DecodeDoubleSSE(const char* src, size_t n, double* vals) {
+  const __m128i sign = _mm_set1_epi64x(kSignBit);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (src + i * sizeof(double)));
+    v = ByteSwap64(v);
+    // Lanes with the sign bit set were non-negative before encoding.
+    __m128i neg = _mm_cmpgt_epi64(zero, v);
+    __m128i mask = _mm_or_si128(sign, _mm_xor_si128(neg, _mm_set1_epi8(-1)));
+    _mm_storeu_si128((__m128i*) (vals + i), _mm_xor_si128(v, mask));
+  }
+  DecodeDoubleScalar(src + i * sizeof(double), n - i, vals + i);
+}
+
+// The AVX2 kernels are compiled for AVX2 regardless of the build flags
+// and only selected when the CPU reports support for it at runtime.
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET inline __m256i ByteSwap64(__m256i v) {
+  const __m256i shuffle = _mm256_set_epi8(
+    8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+    8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm256_shuffle_epi8(v, shuffle);
+}
+
+AVX2_TARGET void EncodeInt64AVX2(const int64_t* vals, size_t n, char* dst) {
+  const __m256i sign = _mm256_set1_epi64x(kSignBit);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) (vals + i));
+    v = ByteSwap64(_mm256_xor_si256(v, sign));
+    _mm256_storeu_si256((__m256i*) (dst + i * sizeof(int64_t)), v);
+  }
+  EncodeInt64Scalar(vals + i, n - i, dst + i * sizeof(int64_t));
+}
+
+AVX2_TARGET void DecodeInt64AVX2(const char* src, size_t n, int64_t* vals) {
+  const __m256i sign = _mm256_set1_epi64x(kSignBit);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256(
+      (const __m256i*) (src + i * sizeof(int64_t)));
+    v = _mm256_xor_si256(ByteSwap64(v), sign);
+    _mm256_storeu_si256((__m256i*) (vals + i), v);
+  }
+  DecodeInt64Scalar(src + i * sizeof(int64_t), n - i, vals + i);
+}
+
+AVX2_TARGET void EncodeDoubleAVX2(const double* vals, size_t n, char* dst) {
+  const __m256i sign = _mm256_set1_epi64x(kSignBit);
+  const __m256i ones = _mm256_set1_epi8(-1);
+  const __m256d zero = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d d = _mm256_add_pd(_mm256_loadu_pd(vals + i), zero);
+    __m256i ge = _mm256_castpd_si256(_mm256_cmp_pd(d, zero, _CMP_GE_OQ));
+    __m256i mask = _mm256_or_si256(sign, _mm256_xor_si256(ge, ones));
+    __m256i v = ByteSwap64(_mm256_xor_si256(_mm256_castpd_si256(d), mask));
+    _mm256_storeu_si256((__m256i*) (dst + i * sizeof(double)), v);
+  }
+  EncodeDoubleScalar(vals + i, n - i, dst + i * sizeof(double));
+}
+
+AVX2_TARGET void DecodeDoubleAVX2(const char* src, size_t n, double* vals) {
+  const __m256i sign = _mm256_set1_epi64x(kSignBit);
+  const __m256i ones = _mm256_set1_epi8(-1);
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256(
+      (const __m256i*) (src + i * sizeof(double)));
+    v = ByteSwap64(v);
+    __m256i neg = _mm256_cmpgt_epi64(zero, v);
+    __m256i mask = _mm256_or_si256(sign, _mm256_xor_si256(neg, ones));
+    _mm256_storeu_si256((__m256i*) (vals + i), _mm256_xor_si256(v, mask));
+  }
+  DecodeDoubleScalar(src + i * sizeof(double), n - i, vals + i);
+}
+
+#undef AVX2_TARGET
+
+#endif  // __SSE4_2__
+
+struct BatchKernels {
+  void (*encode_int64)(const int64_t*, size_t, char*);
+  void (*decode_int64)(const char*, size_t, int64_t*);
+  void (*encode_double)(const double*, size_t, char*);
+  void (*decode_double)(const char*, size_t, double*);
+};
+
+BatchKernels SelectKernels() {
+#ifdef __SSE4_2__
+  if (__builtin_cpu_supports("avx2")) {
+    return {EncodeInt64AVX2, DecodeInt64AVX2,
+            EncodeDoubleAVX2, DecodeDoubleAVX2};
+  }
+  return {EncodeInt64SSE, DecodeInt64SSE, EncodeDoubleSSE, DecodeDoubleSSE};
+#else
+  return {EncodeInt64Scalar, DecodeInt64Scalar,
+          EncodeDoubleScalar, DecodeDoubleScalar};
+#endif
+}
+
+const BatchKernels& Kernels() {
+  static const BatchKernels kernels = SelectKernels();
+  return kernels;
+}
+
+// Grow out by n fixed width values and return where they start.
+char* AppendBatch(std::string& out, size_t n, size_t width) {
+  size_t start = out.size();
+  out.resize(start + n * width);
+  return &out[start];
+}
+
+}  // namespace
+
+void SerializeBatch(const int64_t* vals, size_t n, std::string& out) {
+  Kernels().encode_int64(vals, n, AppendBatch(out, n, sizeof(int64_t)));
+}
+
+void SerializeBatch(const double* vals, size_t n, std::string& out) {
+  Kernels().encode_double(vals, n, AppendBatch(out, n, sizeof(double)));
+}
+
+void DeserializeBatch(rocksdb::Slice& in, int64_t* vals, size_t n) {
+  assert(in.size() >= n * sizeof(int64_t));
+  Kernels().decode_int64(in.data(), n, vals);
+  in.remove_prefix(n * sizeof(int64_t));
+}
+
+void DeserializeBatch(rocksdb::Slice& in, double* vals, size_t n) {
+  assert(in.size() >= n * sizeof(double));
+  Kernels().decode_double(in.data(), n, vals);
+  in.remove_prefix(n * sizeof(double));
+}
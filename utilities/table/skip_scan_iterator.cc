@@ -0,0 +1,84 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/skip_scan_iterator.h"
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+SkipScanIterator::SkipScanIterator(Iterator* it,
+                                   const KeyColumnRange& range)
+  : it_(it),
+    range_(range),
+    seeks_(0),
+    done_(false) {}
+
+void SkipScanIterator::SeekToFirst() {
+  done_ = false;
+  it_->SeekToFirst();
+  FindMatch();
+}
+
+void SkipScanIterator::Seek(const Slice& target) {
+  done_ = false;
+  it_->Seek(target);
+  FindMatch();
+}
+
+void SkipScanIterator::Next() {
+  it_->Next();
+  FindMatch();
+}
+
+Status SkipScanIterator::status() const {
+  return status_.ok() ? it_->status() : status_;
+}
+
+void SkipScanIterator::Unsupported() {
+  status_ = Status::NotSupported("SkipScanIterator only moves forward");
+}
+
+void SkipScanIterator::SkipTo(const Slice& target) {
+  for (int i = 0; i < kNextsBeforeSeek; i++) {
+    it_->Next();
+    if (!it_->Valid() || it_->key().compare(target) >= 0) {
+      return;
+    }
+  }
+  seeks_++;
+  it_->Seek(target);
+}
+
+void SkipScanIterator::FindMatch() {
+  Slice leading;
+  while (status_.ok() && !done_ && it_->Valid()) {
+    switch (range_.Locate(it_->key(), &leading)) {
+      case KeyColumnRange::kIncomplete:
+        // Too short to have the column, e.g. a row of another table.
+        it_->Next();
+        break;
+      case KeyColumnRange::kBelow:
+        // Before the range within this leading value.
+        target_.assign(leading.data(), leading.size());
+        target_.append(range_.lower());
+        SkipTo(target_);
+        break;
+      case KeyColumnRange::kAbove:
+        // Past the range; go to the next leading value.
+        target_ = PrefixSuccessor(leading);
+        if (target_.empty()) {
+          // The leading columns are all 0xFF bytes, the last possible
+          // value. Nothing is left to scan.
+          done_ = true;
+          return;
+        }
+        SkipTo(target_);
+        break;
+      case KeyColumnRange::kInRange:
+        return;
+    }
+  }
+}
+
+}}  // namespace rocksdb::table
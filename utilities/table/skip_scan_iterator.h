@@ -0,0 +1,72 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/iterator.h"
+#include "utilities/table/key_column_range.h"
+
+namespace rocksdb { namespace table {
+
+// Visits the keys whose column lies in a KeyColumnRange, with the leading
+// columns unconstrained:
+//
+//   WHERE col1 BETWEEN a AND b   -- on keys (col0, col1, ...)
+//
+// Rather than reading every row, it seeks past the rows of each distinct
+// value of the leading columns that are outside the range: to the lower
+// bound within the same leading value, or to the successor of the
+// leading value once the column is past the upper bound. With few
+// distinct leading values (schema ids, tenant ids) a scan takes a few
+// seeks per value.
+//
+// Keys are compared bytewise, so the DB must use the default comparator.
+// Only forward iteration is supported.
+class SkipScanIterator : public Iterator {
+ public:
+  // Takes ownership of it.
+  SkipScanIterator(Iterator* it, const KeyColumnRange& range);
+
+  virtual bool Valid() const override { return !done_ && it_->Valid(); }
+  virtual void SeekToFirst() override;
+  virtual void Seek(const Slice& target) override;
+  virtual void Next() override;
+  virtual Slice key() const override { return it_->key(); }
+  virtual Slice value() const override { return it_->value(); }
+  virtual Status status() const override;
+
+  virtual void SeekToLast() override { Unsupported(); }
+  virtual void SeekForPrev(const Slice& /* target */) override {
+    Unsupported();
+  }
+  virtual void Prev() override { Unsupported(); }
+
+  // Seeks issued to skip rows, for reporting.
+  uint64_t seeks() const { return seeks_; }
+
+ private:
+  // Nexts to try before seeking, since a seek costs more than a few
+  // Nexts when the target is close.
+  static const int kNextsBeforeSeek = 8;
+
+  // Move forward to the first key in the range, starting at the current
+  // one.
+  void FindMatch();
+  // Move to the first key >= target.
+  void SkipTo(const Slice& target);
+  void Unsupported();
+
+  std::unique_ptr<Iterator> it_;
+  KeyColumnRange range_;
+  std::string target_;
+  uint64_t seeks_;
+  // Set when no key after the current one can be in range.
+  bool done_;
+  Status status_;
+};
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/skip_scan_iterator.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+
+// An iterator over sorted keys in memory that counts its seeks.
+class VectorIterator : public Iterator {
+ public:
+  VectorIterator(std::vector<std::string> keys, int* seeks)
+    : keys_(std::move(keys)), pos_(keys_.size()), seeks_(seeks) {
+    std::sort(keys_.begin(), keys_.end());
+  }
+
+  virtual bool Valid() const override { return pos_ < keys_.size(); }
+  virtual void SeekToFirst() override { pos_ = 0; }
+  virtual void SeekToLast() override { pos_ = keys_.size() - 1; }
+  virtual void Seek(const Slice& target) override {
+    (*seeks_)++;
+    pos_ = std::lower_bound(keys_.begin(), keys_.end(), target.ToString()) -
+           keys_.begin();
+  }
+  virtual void SeekForPrev(const Slice& /* target */) override {}
+  virtual void Next() override { pos_++; }
+  virtual void Prev() override { pos_--; }
+  virtual Slice key() const override { return keys_[pos_]; }
+  virtual Slice value() const override { return Slice(); }
+  virtual Status status() const override { return Status::OK(); }
+
+ private:
+  std::vector<std::string> keys_;
+  size_t pos_;
+  int* seeks_;
+};
+
+std::string Key(int64_t leading, int64_t column) {
+  std::string key;
+  Serialize<int64_t>(leading, key);
+  Serialize<int64_t>(column, key);
+  return key;
+}
+
+std::string Column(int64_t column) {
+  std::string encoded;
+  Serialize<int64_t>(column, encoded);
+  return encoded;
+}
+
+typedef std::vector<std::pair<int64_t, int64_t>> Rows;
+
+Rows Scan(SkipScanIterator* it) {
+  Rows rows;
+  for (; it->Valid(); it->Next()) {
+    Slice in = it->key();
+    int64_t leading = Deserialize<int64_t>(in);
+    rows.emplace_back(leading, Deserialize<int64_t>(in));
+  }
+  EXPECT_TRUE(it->status().ok());
+  return rows;
+}
+
+}  // namespace
+
+TEST(SkipScanIterator, SkipsToLowerBoundOfEachLeadingValue) {
+  std::vector<std::string> keys;
+  for (int64_t leading = 0; leading < 3; leading++) {
+    for (int64_t column = 0; column < 100; column++) {
+      keys.push_back(Key(leading, column));
+    }
+  }
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator(keys, &seeks),
+                      KeyColumnRange({kInt}, Column(50), Column(52)));
+  it.SeekToFirst();
+  EXPECT_EQ(Rows({{0, 50}, {0, 51}, {0, 52}, {1, 50}, {1, 51}, {1, 52},
+                  {2, 50}, {2, 51}, {2, 52}}),
+            Scan(&it));
+  // One seek to the lower bound and one to the next leading value per
+  // leading value, instead of reading 300 rows.
+  EXPECT_EQ(6, seeks);
+  EXPECT_EQ(6U, it.seeks());
+}
+
+TEST(SkipScanIterator, NextsOverShortGaps) {
+  std::vector<std::string> keys;
+  for (int64_t leading = 0; leading < 3; leading++) {
+    for (int64_t column = 0; column < 4; column++) {
+      keys.push_back(Key(leading, column));
+    }
+  }
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator(keys, &seeks),
+                      KeyColumnRange({kInt}, Column(2), Column(2)));
+  it.SeekToFirst();
+  EXPECT_EQ(Rows({{0, 2}, {1, 2}, {2, 2}}), Scan(&it));
+  EXPECT_EQ(0, seeks);
+}
+
+TEST(SkipScanIterator, SeekStartsInsideRange) {
+  std::vector<std::string> keys;
+  for (int64_t leading = 0; leading < 3; leading++) {
+    for (int64_t column = 0; column < 20; column++) {
+      keys.push_back(Key(leading, column));
+    }
+  }
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator(keys, &seeks),
+                      KeyColumnRange({kInt}, Column(5), Column(6)));
+  it.Seek(Key(1, 6));
+  EXPECT_EQ(Rows({{1, 6}, {2, 5}, {2, 6}}), Scan(&it));
+}
+
+TEST(SkipScanIterator, UnboundedSides) {
+  std::vector<std::string> keys;
+  for (int64_t leading = 0; leading < 2; leading++) {
+    for (int64_t column = 0; column < 3; column++) {
+      keys.push_back(Key(leading, column));
+    }
+  }
+  int seeks = 0;
+  SkipScanIterator below(new VectorIterator(keys, &seeks),
+                         KeyColumnRange({kInt}, "", Column(0)));
+  below.SeekToFirst();
+  EXPECT_EQ(Rows({{0, 0}, {1, 0}}), Scan(&below));
+
+  SkipScanIterator above(new VectorIterator(keys, &seeks),
+                         KeyColumnRange({kInt}, Column(2), ""));
+  above.SeekToFirst();
+  EXPECT_EQ(Rows({{0, 2}, {1, 2}}), Scan(&above));
+}
+
+TEST(SkipScanIterator, StopsAfterLastLeadingValue) {
+  // The largest int64 encodes as all 0xFF bytes, which has no successor.
+  const int64_t kMax = std::numeric_limits<int64_t>::max();
+  std::vector<std::string> keys;
+  for (int64_t column = 0; column < 20; column++) {
+    keys.push_back(Key(1, column));
+    keys.push_back(Key(kMax, column));
+  }
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator(keys, &seeks),
+                      KeyColumnRange({kInt}, Column(3), Column(4)));
+  it.SeekToFirst();
+  EXPECT_EQ(Rows({{1, 3}, {1, 4}, {kMax, 3}, {kMax, 4}}), Scan(&it));
+}
+
+TEST(SkipScanIterator, SkipsShortKeys) {
+  std::vector<std::string> keys = {Key(1, 5), Key(2, 5)};
+  // Keys of another table that end before the column.
+  std::string short_key;
+  Serialize<int64_t>(1, short_key);
+  keys.push_back(short_key);
+  keys.push_back(short_key + "abc");
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator(keys, &seeks),
+                      KeyColumnRange({kInt}, Column(5), Column(5)));
+  it.SeekToFirst();
+  EXPECT_EQ(Rows({{1, 5}, {2, 5}}), Scan(&it));
+}
+
+TEST(SkipScanIterator, BackwardsIsUnsupported) {
+  int seeks = 0;
+  SkipScanIterator it(new VectorIterator({Key(1, 1)}, &seeks),
+                      KeyColumnRange({kInt}, "", ""));
+  it.SeekToFirst();
+  ASSERT_TRUE(it.Valid());
+  it.Prev();
+  EXPECT_TRUE(it.status().IsNotSupported());
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
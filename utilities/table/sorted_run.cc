@@ -0,0 +1,173 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/sorted_run.h"
+
+#include <string.h>
+#include <algorithm>
+#include <queue>
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+// Each row is its line as a fixed64, the sizes of its key and value as
+// fixed32s and then the key and the value. Runs only live for the
+// duration of a load, so the integers are in host byte order.
+const size_t kHeaderSize = 16;
+
+// Bytes written or read per call to the file.
+const size_t kBufferSize = 1 << 20;
+
+void AppendRow(const RunRow& row, std::string* out) {
+  char header[kHeaderSize];
+  uint32_t key_size = static_cast<uint32_t>(row.key.size());
+  uint32_t value_size = static_cast<uint32_t>(row.value.size());
+  memcpy(header, &row.line, 8);
+  memcpy(header + 8, &key_size, 4);
+  memcpy(header + 12, &value_size, 4);
+  out->append(header, sizeof(header));
+  out->append(row.key);
+  out->append(row.value);
+}
+
+}  // namespace
+
+Status WriteSortedRun(Env* env, const Comparator* cmp,
+                      std::vector<RunRow>* rows, const std::string& path) {
+  std::sort(rows->begin(), rows->end(),
+            [cmp](const RunRow& a, const RunRow& b) {
+              int c = cmp->Compare(a.key, b.key);
+              return c < 0 || (c == 0 && a.line < b.line);
+            });
+  std::unique_ptr<WritableFile> file;
+  Status st = env->NewWritableFile(path, &file, EnvOptions());
+  std::string buffer;
+  for (size_t i = 0; st.ok() && i < rows->size(); i++) {
+    const RunRow& row = (*rows)[i];
+    if (i + 1 < rows->size() &&
+        cmp->Compare(row.key, (*rows)[i + 1].key) == 0) {
+      continue;
+    }
+    AppendRow(row, &buffer);
+    if (buffer.size() >= kBufferSize) {
+      st = file->Append(buffer);
+      buffer.clear();
+    }
+  }
+  if (st.ok() && !buffer.empty()) {
+    st = file->Append(buffer);
+  }
+  if (st.ok()) {
+    st = file->Close();
+  }
+  return st;
+}
+
+Status SortedRunReader::Open(Env* env, const std::string& path) {
+  Status st = env->NewSequentialFile(path, &file_, EnvOptions());
+  if (!st.ok()) {
+    return st;
+  }
+  scratch_.resize(kBufferSize);
+  return Next();
+}
+
+Status SortedRunReader::Fill(size_t n) {
+  while (buffer_.size() - pos_ < n) {
+    if (eof_) {
+      return Status::Corruption("truncated run file");
+    }
+    buffer_.erase(0, pos_);
+    pos_ = 0;
+    Slice chunk;
+    Status st = file_->Read(scratch_.size(), &chunk, scratch_.data());
+    if (!st.ok()) {
+      return st;
+    }
+    eof_ = chunk.empty();
+    buffer_.append(chunk.data(), chunk.size());
+  }
+  return Status::OK();
+}
+
+Status SortedRunReader::Next() {
+  valid_ = false;
+  Status st = Fill(kHeaderSize);
+  if (!st.ok()) {
+    // A file that ends between two rows is complete.
+    return eof_ && pos_ == buffer_.size() ? Status::OK() : st;
+  }
+  uint32_t key_size;
+  uint32_t value_size;
+  memcpy(&line_, buffer_.data() + pos_, 8);
+  memcpy(&key_size, buffer_.data() + pos_ + 8, 4);
+  memcpy(&value_size, buffer_.data() + pos_ + 12, 4);
+  st = Fill(kHeaderSize + key_size + value_size);
+  if (!st.ok()) {
+    return st;
+  }
+  const char* p = buffer_.data() + pos_ + kHeaderSize;
+  key_ = Slice(p, key_size);
+  value_ = Slice(p + key_size, value_size);
+  pos_ += kHeaderSize + key_size + value_size;
+  valid_ = true;
+  return Status::OK();
+}
+
+Status MergeSortedRuns(
+    Env* env, const Comparator* cmp, const std::vector<std::string>& paths,
+    const std::function<Status(const Slice& key, const Slice& value)>& emit) {
+  // The heap pops the smallest key first, and equal keys in line order.
+  auto after = [cmp](const SortedRunReader* a, const SortedRunReader* b) {
+    int c = cmp->Compare(a->key(), b->key());
+    return c > 0 || (c == 0 && a->line() > b->line());
+  };
+  std::priority_queue<SortedRunReader*, std::vector<SortedRunReader*>,
+                      decltype(after)> heap(after);
+  std::vector<std::unique_ptr<SortedRunReader>> runs;
+  for (const auto& path : paths) {
+    runs.emplace_back(new SortedRunReader());
+    Status st = runs.back()->Open(env, path);
+    if (!st.ok()) {
+      return st;
+    }
+    if (runs.back()->Valid()) {
+      heap.push(runs.back().get());
+    }
+  }
+
+  std::string key;
+  std::string value;
+  while (!heap.empty()) {
+    SortedRunReader* run = heap.top();
+    heap.pop();
+    key.assign(run->key().data(), run->key().size());
+    value.assign(run->value().data(), run->value().size());
+    Status st = run->Next();
+    if (run->Valid()) {
+      heap.push(run);
+    }
+    // Each run holds a key once, so duplicates come from the other runs,
+    // and they pop in line order.
+    while (st.ok() && !heap.empty() &&
+           cmp->Compare(heap.top()->key(), key) == 0) {
+      run = heap.top();
+      heap.pop();
+      value.assign(run->value().data(), run->value().size());
+      st = run->Next();
+      if (run->Valid()) {
+        heap.push(run);
+      }
+    }
+    if (st.ok()) {
+      st = emit(key, value);
+    }
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return Status::OK();
+}
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,73 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb { namespace table {
+
+// A row of a bulk load, tagged with the input line it came from so that
+// the last of duplicate keys wins however the rows were spread over the
+// loading threads.
+struct RunRow {
+  uint64_t line;
+  std::string key;
+  std::string value;
+};
+
+// Sort rows by key under cmp, keeping only the row of the last line of
+// each key, and write them to a run file at path. rows is left sorted.
+Status WriteSortedRun(Env* env, const Comparator* cmp,
+                      std::vector<RunRow>* rows, const std::string& path);
+
+// Reads a run file written by WriteSortedRun front to back.
+class SortedRunReader {
+ public:
+  SortedRunReader() : pos_(0), eof_(false), valid_(false), line_(0) {}
+
+  // Open path and read its first row.
+  Status Open(Env* env, const std::string& path);
+
+  // Read the next row. Valid() is false after the last one.
+  Status Next();
+
+  bool Valid() const { return valid_; }
+  uint64_t line() const { return line_; }
+  // Valid until the next call to Next().
+  Slice key() const { return key_; }
+  Slice value() const { return value_; }
+
+ private:
+  // Make n bytes from pos_ available in buffer_. Fails if the file ends
+  // first.
+  Status Fill(size_t n);
+
+  std::unique_ptr<SequentialFile> file_;
+  std::string buffer_;
+  std::vector<char> scratch_;
+  size_t pos_;
+  bool eof_;
+  bool valid_;
+  uint64_t line_;
+  Slice key_;
+  Slice value_;
+};
+
+// Merge the run files into one sequence in key order with each key once,
+// taking the row of the last line among the runs, and pass every row to
+// emit. Stops at the first error of a run or of emit.
+Status MergeSortedRuns(
+    Env* env, const Comparator* cmp, const std::vector<std::string>& paths,
+    const std::function<Status(const Slice& key, const Slice& value)>& emit);
+
+}}  // namespace rocksdb::table
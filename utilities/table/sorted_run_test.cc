@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <rocksdb/comparator.h>
+#include <rocksdb/env.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utilities/table/sorted_run.h"
+#include "utilities/table/test_util.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+typedef std::vector<std::pair<std::string, std::string>> Rows;
+
+class SortedRunTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    env_ = Env::Default();
+    dir_ = PerTestPath(env_);
+    ASSERT_TRUE(env_->CreateDirIfMissing(dir_).ok());
+  }
+
+  void TearDown() override {
+    for (const auto& path : paths_) {
+      env_->DeleteFile(path);
+    }
+    env_->DeleteDir(dir_);
+  }
+
+  // Write rows, given in input order from first_line on, to a new run.
+  std::string WriteRun(const Rows& rows, uint64_t first_line) {
+    std::vector<RunRow> run;
+    for (size_t i = 0; i < rows.size(); i++) {
+      run.push_back(RunRow{first_line + i, rows[i].first, rows[i].second});
+    }
+    paths_.push_back(dir_ + "/" + std::to_string(paths_.size()) + ".run");
+    EXPECT_TRUE(
+        WriteSortedRun(env_, BytewiseComparator(), &run, paths_.back()).ok());
+    return paths_.back();
+  }
+
+  Status Merge(const std::vector<std::string>& runs, Rows* out) {
+    return MergeSortedRuns(env_, BytewiseComparator(), runs,
+                           [out](const Slice& key, const Slice& value) {
+                             out->emplace_back(key.ToString(),
+                                               value.ToString());
+                             return Status::OK();
+                           });
+  }
+
+  Env* env_;
+  std::string dir_;
+  std::vector<std::string> paths_;
+};
+
+TEST_F(SortedRunTest, SortsAndKeepsLastDuplicate) {
+  std::string run = WriteRun({{"c", "1"}, {"a", "2"}, {"c", "3"},
+                              {"b", "4"}, {"a", "5"}}, 10);
+  SortedRunReader reader;
+  ASSERT_TRUE(reader.Open(env_, run).ok());
+  Rows rows;
+  std::vector<uint64_t> lines;
+  while (reader.Valid()) {
+    rows.emplace_back(reader.key().ToString(), reader.value().ToString());
+    lines.push_back(reader.line());
+    ASSERT_TRUE(reader.Next().ok());
+  }
+  EXPECT_EQ(Rows({{"a", "5"}, {"b", "4"}, {"c", "3"}}), rows);
+  EXPECT_EQ(std::vector<uint64_t>({14, 13, 12}), lines);
+}
+
+TEST_F(SortedRunTest, MergeResolvesDuplicatesByLine) {
+  // The runs overlap, and a later run may hold earlier lines, as when
+  // several threads take turns at the input.
+  std::string later = WriteRun({{"a", "a2"}, {"d", "d2"}, {"b", "b2"}}, 20);
+  std::string earlier = WriteRun({{"b", "b1"}, {"c", "c1"}, {"a", "a1"}}, 10);
+  std::string last = WriteRun({{"b", "b3"}, {"e", "e3"}}, 30);
+  Rows rows;
+  ASSERT_TRUE(Merge({later, earlier, last}, &rows).ok());
+  EXPECT_EQ(Rows({{"a", "a2"}, {"b", "b3"}, {"c", "c1"}, {"d", "d2"},
+                  {"e", "e3"}}),
+            rows);
+
+  rows.clear();
+  ASSERT_TRUE(Merge({last, earlier, later}, &rows).ok());
+  EXPECT_EQ(Rows({{"a", "a2"}, {"b", "b3"}, {"c", "c1"}, {"d", "d2"},
+                  {"e", "e3"}}),
+            rows);
+}
+
+TEST_F(SortedRunTest, RowsLargerThanBuffer) {
+  std::string big(3 << 20, 'x');
+  std::string run = WriteRun({{"b", big}, {"a", "small"}, {"c", big}}, 0);
+  Rows rows;
+  ASSERT_TRUE(Merge({run}, &rows).ok());
+  EXPECT_EQ(Rows({{"a", "small"}, {"b", big}, {"c", big}}), rows);
+}
+
+TEST_F(SortedRunTest, EmptyRuns) {
+  std::string empty = WriteRun({}, 0);
+  std::string run = WriteRun({{"a", "1"}}, 1);
+  Rows rows;
+  ASSERT_TRUE(Merge({empty, run, empty}, &rows).ok());
+  EXPECT_EQ(Rows({{"a", "1"}}), rows);
+
+  rows.clear();
+  ASSERT_TRUE(Merge({}, &rows).ok());
+  EXPECT_TRUE(rows.empty());
+}
+
+TEST_F(SortedRunTest, TruncatedRun) {
+  std::string run = WriteRun({{"a", "1"}, {"b", "2"}}, 0);
+  std::string data;
+  ASSERT_TRUE(ReadFileToString(env_, run, &data).ok());
+  for (size_t cut : {data.size() - 1, data.size() / 2 + 3}) {
+    ASSERT_TRUE(WriteStringToFile(env_, Slice(data.data(), cut), run).ok());
+    Rows rows;
+    EXPECT_TRUE(Merge({run}, &rows).IsCorruption());
+  }
+}
+
+TEST_F(SortedRunTest, EmitErrorStopsMerge) {
+  std::string run = WriteRun({{"a", "1"}, {"b", "2"}}, 0);
+  size_t calls = 0;
+  Status st = MergeSortedRuns(env_, BytewiseComparator(), {run},
+                              [&calls](const Slice&, const Slice&) {
+                                calls++;
+                                return Status::IOError("full");
+                              });
+  EXPECT_TRUE(st.IsIOError());
+  EXPECT_EQ(1U, calls);
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/string_dictionary.h"
+
+#include <iterator>
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+// The int of the first code: near the bottom of the one byte range, as
+// tables are often loaded in key order, with room for a few strings
+// before it.
+const int64_t kFirstCode = 16;
+
+// How far a string added after the last code or before the first goes.
+const int64_t kEndGap = 4;
+
+// Fraction digits are base 128.
+const int kDigits = 128;
+
+// The digits of a fraction between the fractions lo and hi, or between
+// lo and 1 if hi is null. The result ends in the middle of the first
+// digit with room, so inserts at the same spot keep halving the gap.
+std::string DigitsBetween(const std::string& lo, const std::string* hi) {
+  std::string digits;
+  bool bounded = hi != nullptr;
+  for (size_t i = 0;; i++) {
+    int l = i < lo.size() ? (uint8_t) lo[i] : 0;
+    int h = !bounded ? kDigits : i < hi->size() ? (uint8_t) (*hi)[i] : 0;
+    if (h - l >= 2) {
+      digits.push_back((char) (l + (h - l) / 2));
+      return digits;
+    }
+    digits.push_back((char) l);
+    // Below a digit of hi, every fraction is below hi.
+    if (h - l == 1) {
+      bounded = false;
+    }
+  }
+}
+
+}  // namespace
+
+Status StringDictionary::NewCode(
+    const std::string& str,
+    std::map<std::string, DictCode>::const_iterator next,
+    DictCode* code) const {
+  if (codes_.empty()) {
+    *code = DictCode(kFirstCode);
+  } else if (next == codes_.end()) {
+    const DictCode& last = codes_.rbegin()->second;
+    *code = DictCode(last.n <= kDictCodeMax - kEndGap ? last.n + kEndGap
+                                                      : kDictCodeMax);
+    if (!(last < *code)) {
+      code->n = last.n;
+      code->digits = DigitsBetween(last.digits, nullptr);
+    }
+  } else if (next == codes_.begin()) {
+    const DictCode& first = next->second;
+    *code = DictCode(first.n >= -kDictCodeMax + kEndGap ? first.n - kEndGap
+                                                        : -kDictCodeMax);
+    if (!(*code < first)) {
+      if (first.digits.empty()) {
+        return Status::NotSupported(
+            "dictionary " + name_ + " has no code left before " +
+            next->first, str);
+      }
+      code->digits = DigitsBetween(std::string(), &first.digits);
+    }
+  } else {
+    // The middle int above lo and below hi, or a fraction past lo.n if
+    // there is none.
+    const DictCode& lo = std::prev(next)->second;
+    const DictCode& hi = next->second;
+    int64_t top = hi.digits.empty() ? hi.n - 1 : hi.n;
+    if (top > lo.n) {
+      *code = DictCode(lo.n + 1 + (top - lo.n - 1) / 2);
+    } else {
+      *code = DictCode(lo.n);
+      code->digits =
+        DigitsBetween(lo.digits, hi.n == lo.n ? &hi.digits : nullptr);
+    }
+  }
+  return Status::OK();
+}
+
+Status StringDictionary::Intern(const Slice& s, DictCode* code) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string str = s.ToString();
+  auto next = codes_.lower_bound(str);
+  if (next != codes_.end() && next->first == str) {
+    *code = next->second;
+    return Status::OK();
+  }
+  Status st = NewCode(str, next, code);
+  if (!st.ok()) {
+    return st;
+  }
+  codes_.emplace_hint(next, str, *code);
+  strings_.emplace(*code, std::move(str));
+  dirty_ = true;
+  return Status::OK();
+}
+
+Status StringDictionary::Find(const Slice& s, DictCode* code) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string str = s.ToString();
+  auto next = codes_.lower_bound(str);
+  if (next != codes_.end() && next->first == str) {
+    *code = next->second;
+    return Status::OK();
+  }
+  return NewCode(str, next, code);
+}
+
+Status StringDictionary::Lookup(const DictCode& code, std::string* s) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = strings_.find(code);
+  if (it == strings_.end()) {
+    std::string encoded;
+    Serialize<DictCode>(code, encoded);
+    return Status::Corruption("dictionary " + name_ + " has no code",
+                              Slice(encoded).ToString(true));
+  }
+  *s = it->second;
+  return Status::OK();
+}
+
+// The file holds the entries in code order, each a DictCode followed by
+// its string, both in the key encoding.
+Status StringDictionary::Load(Env* env, const std::string& path) {
+  std::string data;
+  Status st = env->FileExists(path);
+  if (st.IsNotFound()) {
+    st = Status::OK();
+  } else if (st.ok()) {
+    st = ReadFileToString(env, path, &data);
+  }
+  if (!st.ok()) {
+    return st;
+  }
+
+  std::map<std::string, DictCode> codes;
+  std::map<DictCode, std::string> strings;
+  Slice in(data);
+  std::string scratch;
+  while (!in.empty()) {
+    const char* end = in.data() + in.size();
+    size_t len = DictCodeLength(in, false);
+    if (len == 0 || len == in.size()) {
+      return Status::Corruption("truncated dictionary", path);
+    }
+    DictCode code = Deserialize<DictCode>(in);
+    if (serialize_internal::FindStringEnd(in.data(), end, kStringEscape,
+                                          kStringEscapedNul) == end) {
+      return Status::Corruption("truncated dictionary", path);
+    }
+    std::string str = DeserializeString(in, &scratch).ToString();
+    // Both the codes and the strings must ascend, or the codes wouldn't
+    // sort like the strings, and a fraction must not end in a 0 digit.
+    if ((!code.digits.empty() && code.digits.back() == 0) ||
+        (!strings.empty() && (!(strings.rbegin()->first < code) ||
+                              str <= strings.rbegin()->second))) {
+      return Status::Corruption("dictionary out of order", path);
+    }
+    codes.emplace_hint(codes.end(), str, code);
+    strings.emplace_hint(strings.end(), code, std::move(str));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  codes_.swap(codes);
+  strings_.swap(strings);
+  dirty_ = false;
+  return Status::OK();
+}
+
+Status StringDictionary::Save(Env* env, const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) {
+    return Status::OK();
+  }
+  std::string data;
+  for (const auto& entry : strings_) {
+    Serialize<DictCode>(entry.first, data);
+    Serialize<Slice>(entry.second, data);
+  }
+  const std::string tmp = path + ".tmp";
+  Status st = WriteStringToFile(env, data, tmp, true);
+  if (st.ok()) {
+    st = env->RenameFile(tmp, path);
+  }
+  if (st.ok()) {
+    dirty_ = false;
+  }
+  return st;
+}
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,75 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+// An order preserving dictionary for a low cardinality string column,
+// such as a country or a status. Strings are stored in keys as their
+// DictCode, and codes are assigned in string order, so the encoded
+// column sorts like the strings and ranges over it stay ranges.
+//
+// The first string takes a code near the bottom of the one byte range,
+// and a string after the last one or before the first takes the int
+// four past it, so two dozen strings added in ascending order take one
+// byte each and thousands take at most three. A string inserted
+// between two others takes an int between theirs or, once there is
+// none left, a fraction between them, a byte longer for every seven
+// inserts at the same spot. Existing codes never change, so rows don't
+// have to be re-encoded, and there is always a code left for a new
+// string.
+//
+// The dictionary is persisted in a file of its own, saved before rows
+// using new codes are written. It is safe to use from several threads.
+class StringDictionary {
+ public:
+  explicit StringDictionary(const std::string& name) : name_(name) {}
+
+  const std::string& name() const { return name_; }
+
+  // The code of s, adding s if it isn't in the dictionary yet.
+  Status Intern(const Slice& s, DictCode* code);
+
+  // The code of s without adding it. If s isn't in the dictionary, this
+  // is a code no string has that sorts between those of its neighbours,
+  // as the code of s would: it bounds ranges like s and matches no row.
+  // Range bounds and lookups use it, so that reads don't add strings.
+  Status Find(const Slice& s, DictCode* code) const;
+
+  // The string of code.
+  Status Lookup(const DictCode& code, std::string* s) const;
+
+  // Replace the contents with the dictionary saved at path. A missing
+  // file is an empty dictionary.
+  Status Load(Env* env, const std::string& path);
+
+  // Write the dictionary to path if strings were added since it was
+  // loaded or last saved. The file is replaced atomically.
+  Status Save(Env* env, const std::string& path);
+
+ private:
+  const std::string name_;
+  mutable std::mutex mutex_;
+  // The code between the codes of the neighbours of str, which isn't in
+  // the dictionary. next is the first entry after str.
+  Status NewCode(const std::string& str,
+                 std::map<std::string, DictCode>::const_iterator next,
+                 DictCode* code) const;
+
+  std::map<std::string, DictCode> codes_;
+  std::map<DictCode, std::string> strings_;
+  bool dirty_ = false;
+};
+
+}}  // namespace rocksdb::table
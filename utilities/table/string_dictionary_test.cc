@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include <rocksdb/env.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/string_dictionary.h"
+#include "utilities/table/test_util.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+// n distinct strings in ascending order.
+std::vector<std::string> SortedStrings(size_t n) {
+  std::vector<std::string> strings;
+  for (size_t i = 0; i < n; i++) {
+    const std::string n = std::to_string(i);
+    strings.push_back("s" + std::string(6 - n.size(), '0') + n);
+  }
+  return strings;
+}
+
+// Intern strings in the given order, then check that the codes and
+// their encodings ascend with the strings and map back to them.
+void InternAndCheck(const std::vector<std::string>& order) {
+  StringDictionary dict("test");
+  for (const auto& s : order) {
+    DictCode code;
+    ASSERT_TRUE(dict.Intern(s, &code).ok()) << s;
+  }
+  std::vector<std::string> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  DictCode last;
+  std::string last_encoded;
+  for (size_t i = 0; i < sorted.size(); i++) {
+    DictCode code;
+    ASSERT_TRUE(dict.Intern(sorted[i], &code).ok());
+    std::string encoded;
+    Serialize<DictCode>(code, encoded);
+    ASSERT_EQ(EncodedSize<DictCode>(code), encoded.size());
+    if (i > 0) {
+      ASSERT_LT(last, code) << sorted[i];
+      ASSERT_LT(last_encoded, encoded) << sorted[i];
+    }
+    Slice in(encoded);
+    ASSERT_EQ(encoded.size(), DictCodeLength(in, false));
+    ASSERT_TRUE(code == Deserialize<DictCode>(in));
+    std::string s;
+    ASSERT_TRUE(dict.Lookup(code, &s).ok());
+    EXPECT_EQ(sorted[i], s);
+    last = code;
+    last_encoded = encoded;
+  }
+}
+
+}  // namespace
+
+class StringDictionaryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    env_ = Env::Default();
+    path_ = PerTestPath(env_);
+  }
+
+  void TearDown() override { env_->DeleteFile(path_); }
+
+  Env* env_;
+  std::string path_;
+};
+
+TEST(StringDictionary, AscendingOrder) {
+  InternAndCheck(SortedStrings(10000));
+}
+
+TEST(StringDictionary, DescendingOrder) {
+  std::vector<std::string> order = SortedStrings(10000);
+  std::reverse(order.begin(), order.end());
+  InternAndCheck(order);
+}
+
+TEST(StringDictionary, RandomOrder) {
+  std::vector<std::string> order = SortedStrings(10000);
+  std::mt19937 rng(301);
+  std::shuffle(order.begin(), order.end(), rng);
+  InternAndCheck(order);
+}
+
+TEST(StringDictionary, InterleavedOrder) {
+  // Every other string ascending, then the rest descending, so each of
+  // them lands between two earlier ones.
+  std::vector<std::string> sorted = SortedStrings(10000);
+  std::vector<std::string> order;
+  for (size_t i = 0; i < sorted.size(); i += 2) {
+    order.push_back(sorted[i]);
+  }
+  for (size_t i = sorted.size() - 1; i < sorted.size(); i -= 2) {
+    order.push_back(sorted[i]);
+  }
+  InternAndCheck(order);
+}
+
+TEST(StringDictionary, LowCardinalityCodesAreSmall) {
+  StringDictionary dict("test");
+  size_t code_size = 0;
+  size_t string_size = 0;
+  for (const char* s : {"US", "DE", "FR", "GB", "JP", "BR", "IN", "CN"}) {
+    DictCode code;
+    ASSERT_TRUE(dict.Intern(s, &code).ok());
+    EXPECT_LE(EncodedSize<DictCode>(code), 2u) << s;
+    code_size += EncodedSize<DictCode>(code);
+    string_size += EncodedSize<std::string>(s);
+  }
+  EXPECT_LT(code_size, string_size);
+
+  // Strings added in order take a byte each for a while.
+  StringDictionary ordered("test");
+  std::vector<std::string> strings = SortedStrings(20);
+  for (const auto& s : strings) {
+    DictCode code;
+    ASSERT_TRUE(ordered.Intern(s, &code).ok());
+    EXPECT_EQ(1u, EncodedSize<DictCode>(code)) << s;
+  }
+}
+
+TEST(StringDictionary, RepeatedInsertsWidenCodes) {
+  StringDictionary dict("test");
+  DictCode a;
+  DictCode b;
+  ASSERT_TRUE(dict.Intern("a", &a).ok());
+  ASSERT_TRUE(dict.Intern("b", &b).ok());
+  // Each string goes right after the last one and before "b", halving
+  // the gap left. Once the ints between them run out, every seven
+  // strings take one more fraction digit.
+  std::string s = "a";
+  DictCode last = a;
+  for (size_t added = 0; added < 100; added++) {
+    s.insert(1, 1, '\x01');
+    DictCode code;
+    ASSERT_TRUE(dict.Intern(s, &code).ok()) << added;
+    ASSERT_LT(last, code);
+    ASSERT_LT(code, b);
+    EXPECT_LE(EncodedSize<DictCode>(code), 2 + added / 7) << added;
+    last = code;
+  }
+  // Nothing else was moved.
+  DictCode code;
+  ASSERT_TRUE(dict.Intern("a", &code).ok());
+  EXPECT_TRUE(a == code);
+  std::string found;
+  EXPECT_TRUE(dict.Lookup(a, &found).ok());
+  EXPECT_EQ("a", found);
+  EXPECT_TRUE(dict.Lookup(DictCode(12345), &found).IsCorruption());
+}
+
+TEST_F(StringDictionaryTest, SaveAndLoad) {
+  StringDictionary dict("test");
+  std::vector<std::string> strings = {"fr", "de", std::string("a\0b", 3),
+                                      "us", ""};
+  std::vector<DictCode> codes;
+  for (const auto& s : strings) {
+    codes.emplace_back();
+    ASSERT_TRUE(dict.Intern(s, &codes.back()).ok());
+  }
+  ASSERT_TRUE(dict.Save(env_, path_).ok());
+
+  StringDictionary loaded("test");
+  ASSERT_TRUE(loaded.Load(env_, path_).ok());
+  for (size_t i = 0; i < strings.size(); i++) {
+    std::string s;
+    ASSERT_TRUE(loaded.Lookup(codes[i], &s).ok());
+    EXPECT_EQ(strings[i], s);
+    DictCode code;
+    ASSERT_TRUE(loaded.Intern(strings[i], &code).ok());
+    EXPECT_TRUE(codes[i] == code);
+  }
+
+  // Nothing new to save.
+  ASSERT_TRUE(env_->DeleteFile(path_).ok());
+  ASSERT_TRUE(loaded.Save(env_, path_).ok());
+  EXPECT_TRUE(env_->FileExists(path_).IsNotFound());
+
+  // A missing file is an empty dictionary.
+  ASSERT_TRUE(loaded.Load(env_, path_).ok());
+  std::string s;
+  EXPECT_TRUE(loaded.Lookup(codes[0], &s).IsCorruption());
+}
+
+TEST_F(StringDictionaryTest, LoadRejectsCorruptFiles) {
+  StringDictionary dict("test");
+  DictCode code;
+  ASSERT_TRUE(dict.Intern("abc", &code).ok());
+  ASSERT_TRUE(dict.Intern("abd", &code).ok());
+  // Fill the ints between the two, so that the last code has fraction
+  // digits to cut into.
+  DictCode between;
+  for (const char* s : {"abc\x01", "abc\x02", "abc\x03"}) {
+    ASSERT_TRUE(dict.Intern(s, &between).ok());
+  }
+  ASSERT_FALSE(between.digits.empty());
+  ASSERT_TRUE(dict.Save(env_, path_).ok());
+  std::string data;
+  ASSERT_TRUE(ReadFileToString(env_, path_, &data).ok());
+
+  // Cut inside a code or a string.
+  std::set<size_t> entry_ends;
+  for (Slice in(data); !in.empty();) {
+    SkipEncoded<DictCode>(in);
+    SkipEncoded<Slice>(in);
+    entry_ends.insert(data.size() - in.size());
+  }
+  for (size_t cut = 1; cut < data.size(); cut++) {
+    if (entry_ends.count(cut)) {
+      continue;
+    }
+    ASSERT_TRUE(WriteStringToFile(env_, Slice(data.data(), cut), path_).ok());
+    StringDictionary loaded("test");
+    EXPECT_TRUE(loaded.Load(env_, path_).IsCorruption()) << cut;
+  }
+
+  // A fraction ending in a 0 digit.
+  std::string zero;
+  Serialize<VarInt64>(2 * 5 + 1, zero);
+  zero.push_back('\0');
+  Serialize<Slice>("b", zero);
+  ASSERT_TRUE(WriteStringToFile(env_, zero, path_).ok());
+  EXPECT_TRUE(dict.Load(env_, path_).IsCorruption());
+
+  // Codes that don't ascend with the strings.
+  std::string swapped;
+  Serialize<DictCode>(2, swapped);
+  Serialize<Slice>("b", swapped);
+  Serialize<DictCode>(1, swapped);
+  Serialize<Slice>("c", swapped);
+  ASSERT_TRUE(WriteStringToFile(env_, swapped, path_).ok());
+  EXPECT_TRUE(dict.Load(env_, path_).IsCorruption());
+
+  std::string descending;
+  Serialize<DictCode>(1, descending);
+  Serialize<Slice>("c", descending);
+  Serialize<DictCode>(2, descending);
+  Serialize<Slice>("b", descending);
+  ASSERT_TRUE(WriteStringToFile(env_, descending, path_).ok());
+  EXPECT_TRUE(dict.Load(env_, path_).IsCorruption());
+
+  // A failed load keeps the dictionary.
+  std::string s;
+  ASSERT_TRUE(dict.Lookup(code, &s).ok());
+  EXPECT_EQ("abd", s);
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
 #include "rocksdb/utilities/serialize.h"
+#include "rocksdb/utilities/tuple_view.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 using ::testing::InitGoogleTest;
 
@@ -40,6 +46,15 @@ TEST(Basic, NegativeDouble) {
   EXPECT_EQ(-1.234, d1);
 }
 
+TEST(Basic, ZeroDouble) {
+  std::string out;
+
+  Serialize<double>(0.0, out);
+  auto s = rocksdb::Slice(out);
+  auto d1 = Deserialize<double>(s);
+  EXPECT_EQ(0.0, d1);
+}
+
 TEST(Basic, Bool) {
   std::string out;
 
@@ -64,6 +79,49 @@ TEST(Basic, String) {
   EXPECT_EQ("world", s2);
 }
 
+TEST(Basic, EmbeddedNul) {
+  std::string out;
+  const std::string with_nul("a\0b\0", 4);
+
+  Serialize<std::string>(with_nul, out);
+  Serialize<std::string>("c", out);
+  auto s = rocksdb::Slice(out);
+  auto s1 = Deserialize<std::string>(s);
+  EXPECT_EQ(with_nul, s1);
+  auto s2 = Deserialize<std::string>(s);
+  EXPECT_EQ("c", s2);
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(Basic, SliceIsZeroCopy) {
+  std::string out;
+
+  Serialize<rocksdb::Slice>(rocksdb::Slice("hello"), out);
+  Serialize<rocksdb::Slice>(rocksdb::Slice("a\0b", 3), out);
+  auto s = rocksdb::Slice(out);
+  std::string scratch;
+  auto s1 = DeserializeString(s, &scratch);
+  EXPECT_EQ(rocksdb::Slice("hello"), s1);
+  EXPECT_EQ(out.data(), s1.data());
+  auto s2 = DeserializeString(s, &scratch);
+  EXPECT_EQ(rocksdb::Slice("a\0b", 3), s2);
+  EXPECT_EQ(scratch.data(), s2.data());
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(Basic, SliceWithNulNeedsScratch) {
+  std::string out;
+
+  Serialize<rocksdb::Slice>(rocksdb::Slice("hello"), out);
+  auto s = rocksdb::Slice(out);
+  EXPECT_EQ(rocksdb::Slice("hello"), Deserialize<rocksdb::Slice>(s));
+
+  out.clear();
+  Serialize<rocksdb::Slice>(rocksdb::Slice("a\0b", 3), out);
+  s = rocksdb::Slice(out);
+  EXPECT_DEBUG_DEATH(Deserialize<rocksdb::Slice>(s), "");
+}
+
 template<typename T>
 std::string SerializeHelper(T t) {
   std::string out;
@@ -89,15 +147,373 @@ TEST(Ordering, Double) {
   EXPECT_LT(SerializeHelper<double>(2.0), SerializeHelper<double>(positive_infinity));
 }
 
+// Round trips and orders the limits of T, -1 (or 1), 0 and 1 at
+// EncodedWidth<T>::kSize bytes each.
+template<typename T>
+void CheckNarrow() {
+  std::vector<T> vals = {std::numeric_limits<T>::lowest(),
+                         std::is_signed<T>::value ? T(-1) : T(1), T(0),
+                         T(1), std::numeric_limits<T>::max()};
+  std::sort(vals.begin(), vals.end());
+  std::string prev;
+  for (T v : vals) {
+    std::string enc = SerializeHelper<T>(v);
+    EXPECT_EQ(size_t(EncodedWidth<T>::kSize), enc.size());
+    EXPECT_LE(prev, enc);
+    rocksdb::Slice in(enc);
+    EXPECT_EQ(v, Deserialize<T>(in));
+    EXPECT_TRUE(in.empty());
+    prev = enc;
+  }
+}
+
+TEST(Ordering, NarrowInts) {
+  CheckNarrow<int8_t>();
+  CheckNarrow<int16_t>();
+  CheckNarrow<int32_t>();
+  CheckNarrow<uint8_t>();
+  CheckNarrow<uint16_t>();
+  CheckNarrow<uint32_t>();
+  CheckNarrow<uint64_t>();
+  EXPECT_EQ(std::string("\x80\x00\x00\x05", 4), SerializeHelper<int32_t>(5));
+  EXPECT_EQ(std::string("\x7f\xff", 2), SerializeHelper<int16_t>(-1));
+}
+
+TEST(Ordering, Float) {
+  CheckNarrow<float>();
+  EXPECT_LT(SerializeHelper<float>(-2.5f), SerializeHelper<float>(-1.0f));
+  EXPECT_LT(SerializeHelper<float>(-1.0f), SerializeHelper<float>(0.5f));
+  EXPECT_LT(SerializeHelper<float>(0.5f),
+            SerializeHelper<float>(std::numeric_limits<float>::infinity()));
+  std::string out = SerializeHelper<float>(0.0f);
+  rocksdb::Slice in(out);
+  EXPECT_EQ(0.0f, Deserialize<float>(in));
+}
+
+TEST(Ordering, NegativeZero) {
+  EXPECT_EQ(SerializeHelper<double>(0.0), SerializeHelper<double>(-0.0));
+  EXPECT_LT(SerializeHelper<double>(-std::numeric_limits<double>::denorm_min()),
+            SerializeHelper<double>(-0.0));
+  EXPECT_EQ(SerializeHelper<float>(0.0f), SerializeHelper<float>(-0.0f));
+  EXPECT_LT(SerializeHelper<float>(-std::numeric_limits<float>::denorm_min()),
+            SerializeHelper<float>(-0.0f));
+
+  std::string out = SerializeHelper<double>(-0.0);
+  rocksdb::Slice in(out);
+  EXPECT_FALSE(std::signbit(Deserialize<double>(in)));
+  out = SerializeHelper<float>(-0.0f);
+  in = rocksdb::Slice(out);
+  EXPECT_FALSE(std::signbit(Deserialize<float>(in)));
+}
+
+TEST(Ordering, Timestamp) {
+  EXPECT_EQ(SerializeHelper<int64_t>(1500000000123456),
+            SerializeHelper<Timestamp>(1500000000123456));
+  std::string out;
+  SerializeDescending<Timestamp>(-7, out);
+  rocksdb::Slice in(out);
+  EXPECT_EQ(-7, DeserializeDescending<Timestamp>(in).micros);
+}
+
 TEST(Ordering, String) {
   EXPECT_LT(SerializeHelper<std::string>("bar"), SerializeHelper<std::string>("foo"));
   EXPECT_LT(SerializeHelper<std::string>("foo"), SerializeHelper<std::string>("foobar"));
+  const std::string nul("foo\0", 4);
+  EXPECT_LT(SerializeHelper<std::string>("foo"), SerializeHelper<std::string>(nul));
+  EXPECT_LT(SerializeHelper<std::string>(nul), SerializeHelper<std::string>("foo\x01"));
+  EXPECT_LT(SerializeHelper<std::string>(nul), SerializeHelper<std::string>("foobar"));
 }
 
 TEST(Ordering, bool) {
   EXPECT_LT(SerializeHelper<bool>(false), SerializeHelper<bool>(true));
 }
 
+TEST(Tuple, MatchesPerColumn) {
+  std::string expected;
+  Serialize<int64_t>(42, expected);
+  Serialize<std::string>("hello", expected);
+  Serialize<double>(-1.5, expected);
+  Serialize<bool>(true, expected);
+
+  std::string out;
+  SerializeTuple(std::make_tuple(int64_t(42), std::string("hello"), -1.5,
+                                 true),
+                 out);
+  EXPECT_EQ(expected, out);
+  EXPECT_EQ(expected.size(),
+            EncodedSize(std::make_tuple(int64_t(42), std::string("hello"),
+                                        -1.5, true)));
+}
+
+TEST(Tuple, RoundTrip) {
+  std::string name = "world";
+  int64_t id = -7;
+  std::string out;
+  SerializeTuple(std::forward_as_tuple(id, name, 2.5), out);
+
+  auto s = rocksdb::Slice(out);
+  auto t = DeserializeTuple<int64_t, std::string, double>(s);
+  EXPECT_EQ(-7, std::get<0>(t));
+  EXPECT_EQ("world", std::get<1>(t));
+  EXPECT_EQ(2.5, std::get<2>(t));
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(Tuple, FixedWidth) {
+  static_assert(TupleWidth<int64_t, double, bool>::kFixed, "fixed");
+  static_assert(TupleWidth<int64_t, double, bool>::kSize == 17, "size");
+  static_assert(!TupleWidth<int64_t, std::string>::kFixed, "variable");
+  static_assert(TupleWidth<int64_t, std::string>::kSize == 8, "prefix");
+}
+
+TEST(Batch, Int64) {
+  std::vector<int64_t> vals = {
+    0, 1, -1, 1234, -1234, std::numeric_limits<int64_t>::min(),
+    std::numeric_limits<int64_t>::max(), 42, -42,
+  };
+  std::string expected;
+  for (auto v : vals) {
+    Serialize<int64_t>(v, expected);
+  }
+  std::string out;
+  SerializeBatch(vals.data(), vals.size(), out);
+  EXPECT_EQ(expected, out);
+
+  std::vector<int64_t> decoded(vals.size());
+  auto s = rocksdb::Slice(out);
+  DeserializeBatch(s, decoded.data(), decoded.size());
+  EXPECT_EQ(vals, decoded);
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(Batch, Double) {
+  std::vector<double> vals = {
+    0.0, 1.234, -1.234, 1e300, -1e-300,
+    std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(), 2.5, -2.5, -0.0, 3.0, -0.0,
+  };
+  std::string expected;
+  for (auto v : vals) {
+    Serialize<double>(v, expected);
+  }
+  std::string out;
+  SerializeBatch(vals.data(), vals.size(), out);
+  EXPECT_EQ(expected, out);
+
+  std::vector<double> decoded(vals.size());
+  auto s = rocksdb::Slice(out);
+  DeserializeBatch(s, decoded.data(), decoded.size());
+  EXPECT_EQ(vals, decoded);
+  EXPECT_EQ(0U, s.size());
+}
+
+template<typename T>
+std::string SerializeDescendingHelper(T t) {
+  std::string out;
+  SerializeDescending<T>(t, out);
+  return out;
+}
+
+TEST(Descending, RoundTrip) {
+  const std::string with_nul("x\0y", 3);
+  std::string out;
+  SerializeDescending<int64_t>(-1234, out);
+  SerializeDescending<double>(1.5, out);
+  SerializeDescending<bool>(true, out);
+  SerializeDescending<std::string>(with_nul, out);
+  SerializeDescending<std::string>("hello", out);
+  Serialize<int64_t>(7, out);
+
+  auto s = rocksdb::Slice(out);
+  EXPECT_EQ(-1234, DeserializeDescending<int64_t>(s));
+  EXPECT_EQ(1.5, DeserializeDescending<double>(s));
+  EXPECT_EQ(true, DeserializeDescending<bool>(s));
+  EXPECT_EQ(with_nul, DeserializeDescending<std::string>(s));
+  EXPECT_EQ("hello", DeserializeDescending<std::string>(s));
+  EXPECT_EQ(7, Deserialize<int64_t>(s));
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(Descending, Ordering) {
+  EXPECT_GT(SerializeDescendingHelper<int64_t>(-1),
+            SerializeDescendingHelper<int64_t>(0));
+  EXPECT_GT(SerializeDescendingHelper<int64_t>(1),
+            SerializeDescendingHelper<int64_t>(2));
+  EXPECT_GT(SerializeDescendingHelper<double>(-1.0),
+            SerializeDescendingHelper<double>(1.0));
+  EXPECT_GT(SerializeDescendingHelper<std::string>("bar"),
+            SerializeDescendingHelper<std::string>("foo"));
+  EXPECT_GT(SerializeDescendingHelper<std::string>("foo"),
+            SerializeDescendingHelper<std::string>("foobar"));
+  EXPECT_GT(SerializeDescendingHelper<std::string>("foo"),
+            SerializeDescendingHelper<std::string>(std::string("foo\0", 4)));
+}
+
+TEST(Descending, MixedTuple) {
+  // (1, "b") < (1, "a") < (2, "z") with the second column descending.
+  std::string k1, k2, k3;
+  SerializeTuple(std::make_tuple(int64_t(1), Desc(std::string("b"))), k1);
+  SerializeTuple(std::make_tuple(int64_t(1), Desc(std::string("a"))), k2);
+  SerializeTuple(std::make_tuple(int64_t(2), Desc(std::string("z"))), k3);
+  EXPECT_LT(k1, k2);
+  EXPECT_LT(k2, k3);
+
+  auto s = rocksdb::Slice(k2);
+  auto t = DeserializeTuple<int64_t, Descending<std::string>>(s);
+  EXPECT_EQ(1, std::get<0>(t));
+  EXPECT_EQ("a", std::get<1>(t));
+}
+
+TEST(VarInt, RoundTrip) {
+  std::vector<int64_t> vals = {
+    0, 1, 239, 240, 255, 256, 65535, 65536, -1, -2, -256, -257,
+    std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(),
+  };
+  std::string out;
+  for (auto v : vals) {
+    Serialize<VarInt64>(v, out);
+    SerializeDescending<VarInt64>(v, out);
+  }
+  auto s = rocksdb::Slice(out);
+  for (auto v : vals) {
+    EXPECT_EQ(v, Deserialize<VarInt64>(s));
+    EXPECT_EQ(v, DeserializeDescending<VarInt64>(s));
+  }
+  EXPECT_EQ(0U, s.size());
+}
+
+TEST(VarInt, Size) {
+  EXPECT_EQ(1U, SerializeHelper<VarInt64>(0).size());
+  EXPECT_EQ(1U, SerializeHelper<VarInt64>(239).size());
+  EXPECT_EQ(2U, SerializeHelper<VarInt64>(240).size());
+  EXPECT_EQ(3U, SerializeHelper<VarInt64>(65535).size());
+  EXPECT_EQ(2U, SerializeHelper<VarInt64>(-256).size());
+  EXPECT_EQ(9U, SerializeHelper<VarInt64>(
+                  std::numeric_limits<int64_t>::min()).size());
+  for (int64_t v : {0L, 240L, -257L, 1L << 40}) {
+    auto encoded = SerializeHelper<VarInt64>(v);
+    EXPECT_EQ(encoded.size(), EncodedSize<VarInt64>(v));
+    EXPECT_EQ(encoded.size(), VarInt64Length(encoded[0]));
+  }
+}
+
+TEST(Ordering, VarInt) {
+  std::vector<int64_t> vals = {
+    std::numeric_limits<int64_t>::min(), -(1L << 40), -65537, -65536, -257,
+    -256, -255, -2, -1, 0, 1, 238, 239, 240, 255, 256, 65535, 65536,
+    1L << 40, std::numeric_limits<int64_t>::max(),
+  };
+  for (size_t i = 1; i < vals.size(); i++) {
+    EXPECT_LT(SerializeHelper<VarInt64>(vals[i - 1]),
+              SerializeHelper<VarInt64>(vals[i]));
+  }
+}
+
+TEST(TupleView, FixedPrefix) {
+  std::string out;
+  SerializeTuple(std::make_tuple(int64_t(3), 2.5, std::string("x"),
+                                 int64_t(-9)),
+                 out);
+
+  TupleView<int64_t, double, std::string, int64_t> view(out);
+  EXPECT_EQ(2.5, view.get<1>());
+  EXPECT_EQ(3, view.get<0>());
+  EXPECT_EQ(16U, view.column<2>().data() - out.data());
+}
+
+TEST(TupleView, VariableColumns) {
+  const std::string with_nul("b\0c", 3);
+  std::string out;
+  SerializeTuple(std::make_tuple(int64_t(1), std::string("a"),
+                                 VarInt64(300), Desc(with_nul),
+                                 int64_t(42)),
+                 out);
+
+  TupleView<int64_t, rocksdb::Slice, VarInt64, Descending<std::string>,
+            int64_t> view(out);
+  EXPECT_EQ(42, view.get<4>());
+  EXPECT_EQ(with_nul, view.get<3>());
+  EXPECT_EQ(300, view.get<2>());
+  EXPECT_EQ(rocksdb::Slice("a"), view.get<1>());
+  EXPECT_EQ(1, view.get<0>());
+  EXPECT_EQ(std::get<4>(view.ToTuple()), view.get<4>());
+}
+
+TEST(Ordering, PrefixSuccessor) {
+  std::string prefix;
+  SerializeTuple(std::make_tuple(int64_t(7), std::string("ab")), prefix);
+  std::string upper = PrefixSuccessor(prefix);
+  std::string inside = prefix + std::string(8, '\xFF');
+  std::string next;
+  SerializeTuple(std::make_tuple(int64_t(8)), next);
+  EXPECT_LT(inside, upper);
+  EXPECT_LE(upper, next);
+
+  EXPECT_EQ("b", PrefixSuccessor("a\xFF\xFF"));
+  EXPECT_EQ("", PrefixSuccessor("\xFF\xFF"));
+}
+
+TEST(Ordering, FixedString) {
+  std::vector<std::string> vals = {"", "a", "ab", "abc", "b", "ba"};
+  std::string prev;
+  for (const auto& v : vals) {
+    std::string enc;
+    SerializeFixedString(v, 4, enc);
+    EXPECT_EQ(4u, enc.size());
+    if (!prev.empty()) {
+      EXPECT_LT(prev, enc);
+    }
+    rocksdb::Slice in(enc);
+    EXPECT_EQ(v, DeserializeFixedString(in, 4).ToString());
+    EXPECT_TRUE(in.empty());
+    prev = enc;
+  }
+}
+
+TEST(Ordering, DictCode) {
+  // Ints and fractions in ascending order.
+  std::vector<DictCode> codes;
+  std::vector<int64_t> ints = {-kDictCodeMax, -(1LL << 40), -129, -1, 0,
+                               1, 119, 120, 4096, kDictCodeMax};
+  for (int64_t n : ints) {
+    codes.emplace_back(n);
+    for (const char* digits : {"\x01", "\x01\x01", "\x01\x7F", "\x40",
+                               "\x7F", "\x7F\x7F\x01"}) {
+      codes.emplace_back(n);
+      codes.back().digits = digits;
+    }
+  }
+  std::string prev;
+  std::string prev_desc;
+  for (size_t i = 0; i < codes.size(); i++) {
+    const DictCode& c = codes[i];
+    std::string enc;
+    Serialize<DictCode>(c, enc);
+    EXPECT_EQ(EncodedSize<DictCode>(c), enc.size());
+    std::string desc;
+    SerializeDescending<DictCode>(c, desc);
+    if (i > 0) {
+      EXPECT_LT(codes[i - 1], c);
+      EXPECT_LT(prev, enc);
+      EXPECT_GT(prev_desc, desc);
+    }
+    rocksdb::Slice in(enc);
+    EXPECT_EQ(enc.size(), DictCodeLength(in, false));
+    EXPECT_EQ(0u, DictCodeLength(rocksdb::Slice(enc.data(), enc.size() - 1),
+                                 false));
+    EXPECT_TRUE(c == Deserialize<DictCode>(in));
+    EXPECT_TRUE(in.empty());
+    in = desc;
+    EXPECT_EQ(desc.size(), DictCodeLength(in, true));
+    EXPECT_TRUE(c == DeserializeDescending<DictCode>(in));
+    EXPECT_TRUE(in.empty());
+    prev = enc;
+    prev_desc = desc;
+  }
+  EXPECT_EQ(1u, EncodedSize<DictCode>(DictCode(119)));
+  EXPECT_EQ(2u, EncodedSize<DictCode>(DictCode(120)));
+}
+
 int main(int argc, char **argv) {
   InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
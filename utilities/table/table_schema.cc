@@ -0,0 +1,460 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/table_schema.h"
+
+#include <assert.h>
+#include <float.h>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/string_dictionary.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+template<typename T>
+void EncodeValue(const T& val, bool descending, std::string* out) {
+  if (descending) {
+    SerializeDescending<T>(val, *out);
+  } else {
+    Serialize<T>(val, *out);
+  }
+}
+
+template<typename T>
+Status DecodeFixed(Slice* in, bool descending, Dynamic* val) {
+  if (in->size() < EncodedWidth<T>::kSize) {
+    return Status::Corruption("truncated column");
+  }
+  if (descending) {
+    *val = Dynamic(DeserializeDescending<T>(*in));
+  } else {
+    *val = Dynamic(Deserialize<T>(*in));
+  }
+  return Status::OK();
+}
+
+// Encode v as a T, which must be able to hold it.
+template<typename T>
+Status EncodeNarrow(int64_t v, bool descending, std::string* out) {
+  bool fits = std::is_signed<T>::value
+      ? v >= static_cast<int64_t>(std::numeric_limits<T>::min()) &&
+        v <= static_cast<int64_t>(std::numeric_limits<T>::max())
+      : v >= 0 && static_cast<uint64_t>(v) <=
+                  static_cast<uint64_t>(std::numeric_limits<T>::max());
+  if (!fits) {
+    return Status::InvalidArgument("out of range for the column",
+                                   std::to_string(v));
+  }
+  EncodeValue<T>(static_cast<T>(v), descending, out);
+  return Status::OK();
+}
+
+// Bytes of an int or double column with a fixed width encoding.
+size_t NumericWidth(ColumnEncoding encoding) {
+  switch (encoding) {
+    case ColumnEncoding::kInt8:
+      return EncodedWidth<int8_t>::kSize;
+    case ColumnEncoding::kInt16:
+      return EncodedWidth<int16_t>::kSize;
+    case ColumnEncoding::kInt32:
+      return EncodedWidth<int32_t>::kSize;
+    case ColumnEncoding::kUInt8:
+      return EncodedWidth<uint8_t>::kSize;
+    case ColumnEncoding::kUInt16:
+      return EncodedWidth<uint16_t>::kSize;
+    case ColumnEncoding::kUInt32:
+      return EncodedWidth<uint32_t>::kSize;
+    case ColumnEncoding::kUInt64:
+      return EncodedWidth<uint64_t>::kSize;
+    case ColumnEncoding::kFloat:
+      return EncodedWidth<float>::kSize;
+    case ColumnEncoding::kTimestamp:
+      return EncodedWidth<Timestamp>::kSize;
+    default:
+      return EncodedWidth<int64_t>::kSize;
+  }
+}
+
+Status DecodeVarint(Slice* in, bool descending, Dynamic* val) {
+  if (in->empty()) {
+    return Status::Corruption("truncated column");
+  }
+  uint8_t prefix = descending ? ~(*in)[0] : (*in)[0];
+  if (in->size() < VarInt64Length(prefix)) {
+    return Status::Corruption("truncated column");
+  }
+  if (descending) {
+    *val = Dynamic(DeserializeDescending<VarInt64>(*in).val);
+  } else {
+    *val = Dynamic(Deserialize<VarInt64>(*in).val);
+  }
+  return Status::OK();
+}
+
+Status DecodeBlank(const ColumnSpec& /* spec */, Slice* /* in */,
+                   Dynamic* val) {
+  *val = Dynamic(Dynamic::T_BLANK);
+  return Status::OK();
+}
+
+Status DecodeString(Slice* in, bool descending, Dynamic* val) {
+  if (in->empty()) {
+    return Status::Corruption("truncated column");
+  }
+  if (descending) {
+    *val = Dynamic(DeserializeDescending<std::string>(*in));
+  } else {
+    *val = Dynamic(Deserialize<std::string>(*in));
+  }
+  return Status::OK();
+}
+
+Status DecodeFixedString(Slice* in, size_t width, bool descending,
+                         Dynamic* val) {
+  if (in->size() < width) {
+    return Status::Corruption("truncated column");
+  }
+  if (descending) {
+    std::string buf(in->data(), width);
+    serialize_internal::InvertBytes(&buf[0], width);
+    Slice tmp(buf);
+    *val = Dynamic(DeserializeFixedString(tmp, width).ToString());
+    in->remove_prefix(width);
+  } else {
+    *val = Dynamic(DeserializeFixedString(*in, width).ToString());
+  }
+  return Status::OK();
+}
+
+Status DecodeDictionary(const StringDictionary& dictionary, Slice* in,
+                        bool descending, Dynamic* val) {
+  if (DictCodeLength(*in, descending) == 0) {
+    return Status::Corruption("truncated column");
+  }
+  DictCode code = descending ? DeserializeDescending<DictCode>(*in)
+                             : Deserialize<DictCode>(*in);
+  std::string str;
+  Status st = dictionary.Lookup(code, &str);
+  if (st.ok()) {
+    *val = Dynamic(std::move(str));
+  }
+  return st;
+}
+
+// The decoders above with the direction bound at compile time, so that
+// they fit ColumnDecoder.
+template<typename T, bool kDescending>
+Status FixedDecoder(const ColumnSpec& /* spec */, Slice* in, Dynamic* val) {
+  return DecodeFixed<T>(in, kDescending, val);
+}
+
+// Decodes a T into a Dynamic holding a Wide, int64_t or double.
+template<typename T, typename Wide, bool kDescending>
+Status NumericDecoder(const ColumnSpec& /* spec */, Slice* in,
+                      Dynamic* val) {
+  if (in->size() < EncodedWidth<T>::kSize) {
+    return Status::Corruption("truncated column");
+  }
+  T v = kDescending ? DeserializeDescending<T>(*in) : Deserialize<T>(*in);
+  *val = Dynamic(static_cast<Wide>(v));
+  return Status::OK();
+}
+
+template<typename T, typename Wide>
+ColumnDecoder NumericDecoderFor(bool desc) {
+  return desc ? &NumericDecoder<T, Wide, true>
+              : &NumericDecoder<T, Wide, false>;
+}
+
+template<bool kDescending>
+Status VarintDecoder(const ColumnSpec& /* spec */, Slice* in,
+                     Dynamic* val) {
+  return DecodeVarint(in, kDescending, val);
+}
+
+template<bool kDescending>
+Status StringDecoder(const ColumnSpec& /* spec */, Slice* in,
+                     Dynamic* val) {
+  return DecodeString(in, kDescending, val);
+}
+
+template<bool kDescending>
+Status FixedStringDecoder(const ColumnSpec& spec, Slice* in, Dynamic* val) {
+  return DecodeFixedString(in, spec.width, kDescending, val);
+}
+
+template<bool kDescending>
+Status DictionaryDecoder(const ColumnSpec& spec, Slice* in, Dynamic* val) {
+  return DecodeDictionary(*spec.dictionary, in, kDescending, val);
+}
+
+Status UnknownDecoder(const ColumnSpec& /* spec */, Slice* /* in */,
+                      Dynamic* /* val */) {
+  return Status::NotSupported("unknown column type");
+}
+
+}  // namespace
+
+Status EncodeFixedString(const ColumnSpec& spec, const Slice& val,
+                         std::string* out) {
+  // Truncating, or dropping trailing NULs with the padding, would make
+  // distinct keys collide.
+  if (val.size() > spec.width) {
+    return Status::InvalidArgument(
+        "longer than char(" + std::to_string(spec.width) + ")", val);
+  }
+  if (!val.empty() && val[val.size() - 1] == '\0') {
+    return Status::InvalidArgument("char(N) values can't end in NUL");
+  }
+  size_t start = out->size();
+  SerializeFixedString(val, spec.width, *out);
+  if (spec.descending) {
+    serialize_internal::InvertBytes(&(*out)[start], spec.width);
+  }
+  return Status::OK();
+}
+
+Status EncodeColumn(const ColumnSpec& spec, const Dynamic& val,
+                    std::string* out) {
+  switch (spec.type) {
+    case Dynamic::T_BLANK:
+      break;
+    case Dynamic::T_BOOL:
+      EncodeValue<bool>(val.getBool(), spec.descending, out);
+      break;
+    case Dynamic::T_DOUBLE:
+      if (spec.encoding == ColumnEncoding::kFloat) {
+        const double v = val.getDouble();
+        // A finite double past FLT_MAX would become infinity.
+        if (std::isfinite(v) && std::abs(v) > FLT_MAX) {
+          return Status::InvalidArgument("out of range for the column",
+                                         std::to_string(v));
+        }
+        EncodeValue<float>(static_cast<float>(v), spec.descending, out);
+      } else {
+        EncodeValue<double>(val.getDouble(), spec.descending, out);
+      }
+      break;
+    case Dynamic::T_INT: {
+      const int64_t v = val.getInt();
+      const bool desc = spec.descending;
+      switch (spec.encoding) {
+        case ColumnEncoding::kVarint:
+          EncodeValue<VarInt64>(v, desc, out);
+          break;
+        case ColumnEncoding::kInt8:
+          return EncodeNarrow<int8_t>(v, desc, out);
+        case ColumnEncoding::kInt16:
+          return EncodeNarrow<int16_t>(v, desc, out);
+        case ColumnEncoding::kInt32:
+          return EncodeNarrow<int32_t>(v, desc, out);
+        case ColumnEncoding::kUInt8:
+          return EncodeNarrow<uint8_t>(v, desc, out);
+        case ColumnEncoding::kUInt16:
+          return EncodeNarrow<uint16_t>(v, desc, out);
+        case ColumnEncoding::kUInt32:
+          return EncodeNarrow<uint32_t>(v, desc, out);
+        case ColumnEncoding::kUInt64:
+          return EncodeNarrow<uint64_t>(v, desc, out);
+        case ColumnEncoding::kTimestamp:
+          EncodeValue<Timestamp>(v, desc, out);
+          break;
+        default:
+          EncodeValue<int64_t>(v, desc, out);
+          break;
+      }
+      break;
+    }
+    case Dynamic::T_STRING:
+    case Dynamic::T_SLICE:
+      if (spec.encoding == ColumnEncoding::kFixed) {
+        return EncodeFixedString(spec, val.getString(), out);
+      } else if (spec.encoding == ColumnEncoding::kDictionary) {
+        DictCode code;
+        Status st = spec.dictionary->Intern(val.getString(), &code);
+        if (!st.ok()) {
+          return st;
+        }
+        EncodeValue<DictCode>(code, spec.descending, out);
+      } else {
+        EncodeValue<std::string>(val.getString(), spec.descending, out);
+      }
+      break;
+  }
+  return Status::OK();
+}
+
+bool SkipColumn(const ColumnSpec& spec, Slice* in) {
+  size_t width = 0;
+  switch (spec.type) {
+    case Dynamic::T_BLANK:
+      return true;
+    case Dynamic::T_BOOL:
+      width = EncodedWidth<bool>::kSize;
+      break;
+    case Dynamic::T_DOUBLE:
+      width = NumericWidth(spec.encoding);
+      break;
+    case Dynamic::T_INT:
+      if (spec.encoding == ColumnEncoding::kVarint) {
+        if (in->empty()) {
+          return false;
+        }
+        uint8_t prefix = spec.descending ? ~(*in)[0] : (*in)[0];
+        width = VarInt64Length(prefix);
+      } else {
+        width = NumericWidth(spec.encoding);
+      }
+      break;
+    case Dynamic::T_STRING:
+    case Dynamic::T_SLICE: {
+      if (spec.encoding == ColumnEncoding::kFixed) {
+        width = spec.width;
+        break;
+      }
+      if (spec.encoding == ColumnEncoding::kDictionary) {
+        width = DictCodeLength(*in, spec.descending);
+        if (width == 0) {
+          return false;
+        }
+        break;
+      }
+      // The escape bytes are inverted too in a descending column.
+      char escape = spec.descending ? ~kStringEscape : kStringEscape;
+      char escaped_nul =
+        spec.descending ? ~kStringEscapedNul : kStringEscapedNul;
+      const char* end = in->data() + in->size();
+      const char* p = serialize_internal::FindStringEnd(in->data(), end,
+                                                        escape, escaped_nul);
+      if (p == end) {
+        return false;
+      }
+      width = p + 2 - in->data();
+      break;
+    }
+  }
+  if (in->size() < width) {
+    return false;
+  }
+  in->remove_prefix(width);
+  return true;
+}
+
+Status DecodeColumn(const ColumnSpec& spec, Slice* in, Dynamic* val) {
+  return DecoderFor(spec)(spec, in, val);
+}
+
+ColumnDecoder DecoderFor(const ColumnSpec& spec) {
+  bool desc = spec.descending;
+  switch (spec.type) {
+    case Dynamic::T_BLANK:
+      return &DecodeBlank;
+    case Dynamic::T_BOOL:
+      return desc ? &FixedDecoder<bool, true> : &FixedDecoder<bool, false>;
+    case Dynamic::T_DOUBLE:
+      if (spec.encoding == ColumnEncoding::kFloat) {
+        return NumericDecoderFor<float, double>(desc);
+      }
+      return desc ? &FixedDecoder<double, true>
+                  : &FixedDecoder<double, false>;
+    case Dynamic::T_INT:
+      switch (spec.encoding) {
+        case ColumnEncoding::kVarint:
+          return desc ? &VarintDecoder<true> : &VarintDecoder<false>;
+        case ColumnEncoding::kInt8:
+          return NumericDecoderFor<int8_t, int64_t>(desc);
+        case ColumnEncoding::kInt16:
+          return NumericDecoderFor<int16_t, int64_t>(desc);
+        case ColumnEncoding::kInt32:
+          return NumericDecoderFor<int32_t, int64_t>(desc);
+        case ColumnEncoding::kUInt8:
+          return NumericDecoderFor<uint8_t, int64_t>(desc);
+        case ColumnEncoding::kUInt16:
+          return NumericDecoderFor<uint16_t, int64_t>(desc);
+        case ColumnEncoding::kUInt32:
+          return NumericDecoderFor<uint32_t, int64_t>(desc);
+        case ColumnEncoding::kUInt64:
+          return NumericDecoderFor<uint64_t, int64_t>(desc);
+        case ColumnEncoding::kTimestamp:
+          return NumericDecoderFor<Timestamp, int64_t>(desc);
+        default:
+          return desc ? &FixedDecoder<int64_t, true>
+                      : &FixedDecoder<int64_t, false>;
+      }
+    case Dynamic::T_STRING:
+    case Dynamic::T_SLICE:
+      if (spec.encoding == ColumnEncoding::kFixed) {
+        return desc ? &FixedStringDecoder<true> : &FixedStringDecoder<false>;
+      }
+      if (spec.encoding == ColumnEncoding::kDictionary) {
+        return desc ? &DictionaryDecoder<true> : &DictionaryDecoder<false>;
+      }
+      return desc ? &StringDecoder<true> : &StringDecoder<false>;
+  }
+  return &UnknownDecoder;
+}
+
+bool FixedWidth(const ColumnSpec& spec, size_t* width) {
+  switch (spec.type) {
+    case Dynamic::T_BLANK:
+      *width = 0;
+      return true;
+    case Dynamic::T_BOOL:
+      *width = EncodedWidth<bool>::kSize;
+      return true;
+    case Dynamic::T_DOUBLE:
+      *width = NumericWidth(spec.encoding);
+      return true;
+    case Dynamic::T_INT:
+      *width = NumericWidth(spec.encoding);
+      return spec.encoding != ColumnEncoding::kVarint;
+    case Dynamic::T_STRING:
+    case Dynamic::T_SLICE:
+      *width = spec.width;
+      return spec.encoding == ColumnEncoding::kFixed;
+  }
+  return false;
+}
+
+size_t FixedLength(const std::vector<ColumnSpec>& specs) {
+  size_t length = 0;
+  for (const auto& spec : specs) {
+    size_t width;
+    if (!FixedWidth(spec, &width)) {
+      return 0;
+    }
+    length += width;
+  }
+  return length;
+}
+
+Status EncodeColumns(const std::vector<ColumnSpec>& specs,
+                     const std::vector<Dynamic>& vals, std::string* out) {
+  assert(specs.size() == vals.size());
+  for (size_t i = 0; i < specs.size(); i++) {
+    Status st = EncodeColumn(specs[i], vals[i], out);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return Status::OK();
+}
+
+Status DecodeColumns(const std::vector<ColumnSpec>& specs, Slice* in,
+                     std::vector<Dynamic>* vals) {
+  vals->resize(specs.size());
+  for (size_t i = 0; i < specs.size(); i++) {
+    Status st = DecodeColumn(specs[i], in, &(*vals)[i]);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  return Status::OK();
+}
+
+}}  // namespace rocksdb::table
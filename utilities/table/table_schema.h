@@ -0,0 +1,133 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/utilities/table_serialization.h"
+
+namespace rocksdb { namespace table {
+
+class StringDictionary;
+
+// On-disk encoding of a column, for Dynamic types that have more than
+// one. kDefault is the fixed width encoding for ints. kFixed is for
+// char(N) strings, padded to ColumnSpec::width bytes. kDictionary
+// strings are stored as their code in ColumnSpec::dictionary.
+//
+// The narrower ints, the unsigned ints and kTimestamp are ints, and
+// kFloat is a double, encoded with the Serialize specialization of that
+// type. Values that don't fit the column fail to encode; kUInt64 only
+// holds what fits in an int64_t, the int of Dynamic.
+enum class ColumnEncoding : uint8_t {
+  kDefault,
+  kVarint,
+  kFixed,
+  kDictionary,
+  kInt8,
+  kInt16,
+  kInt32,
+  kUInt8,
+  kUInt16,
+  kUInt32,
+  kUInt64,
+  kFloat,
+  kTimestamp,
+};
+
+// One key or value column of a schema.
+struct ColumnSpec {
+  Dynamic::Type type;
+  // Encode the column with SerializeDescending so that it sorts in
+  // reverse under the bytewise comparator.
+  bool descending;
+  ColumnEncoding encoding;
+  // Bytes of a kFixed string column.
+  uint32_t width;
+  // Codes of a kDictionary string column, shared by every column that
+  // names the dictionary.
+  std::shared_ptr<StringDictionary> dictionary;
+};
+
+// A column of a row: key column n, or value column n.
+struct ColumnRef {
+  bool value;
+  int n;
+};
+
+// A secondary index of a table. Its entries have the schema id id and
+// the key
+//
+//   <columns before the schema id> <id> <columns> <primary key>
+//
+// with an empty value, so that rows are found by a prefix scan on the
+// indexed columns. See SchemaRegistry::IndexKeys.
+struct IndexSpec {
+  int64_t id;
+  std::vector<ColumnRef> columns;
+};
+
+struct TableSchema {
+  std::vector<ColumnSpec> key;
+  std::vector<ColumnSpec> value;
+  // Rows expire retention seconds after the time in key column
+  // ttl_column, an int of seconds since the epoch. -1 if rows don't
+  // expire.
+  int ttl_column = -1;
+  int64_t retention = 0;
+  // Key columns whose min and max are recorded per SST file, see
+  // ZoneMapCollector. Sorted by SchemaRegistry::Add.
+  std::vector<int> zone_map_columns;
+  std::vector<IndexSpec> indexes;
+};
+
+// Append the encoding of val, a value of the column spec, to out. Fails
+// if val doesn't fit the column: an int out of range of a narrower
+// encoding, a string that EncodeFixedString rejects, or a string that
+// can't be added to the dictionary of the column.
+Status EncodeColumn(const ColumnSpec& spec, const Dynamic& val,
+                    std::string* out);
+
+// Append val to out as a kFixed column of spec, padded with NULs to its
+// width. Fails if val is longer than the width, or ends in a NUL: the
+// padding would hide it, so "a" and "a\0" would be the same key.
+Status EncodeFixedString(const ColumnSpec& spec, const Slice& val,
+                         std::string* out);
+
+// Decode one column described by spec from in into *val and consume it.
+Status DecodeColumn(const ColumnSpec& spec, Slice* in, Dynamic* val);
+
+// Consume one encoded column described by spec from in without decoding
+// it. Returns false, leaving in unchanged, if in ends inside the column.
+bool SkipColumn(const ColumnSpec& spec, Slice* in);
+
+// Whether columns of spec always take the same number of bytes, and how
+// many.
+bool FixedWidth(const ColumnSpec& spec, size_t* width);
+
+// The encoded length of columns of specs if every one of them is fixed
+// width, otherwise 0.
+size_t FixedLength(const std::vector<ColumnSpec>& specs);
+
+// Decodes one column of spec, see DecoderFor.
+typedef Status (*ColumnDecoder)(const ColumnSpec& spec, Slice* in,
+                                Dynamic* val);
+
+// The decoder of columns described by spec. Looking it up once and
+// calling it for every row avoids switching on the spec per column.
+ColumnDecoder DecoderFor(const ColumnSpec& spec);
+
+// Encode or decode vals column by column. vals must have one entry per
+// spec.
+Status EncodeColumns(const std::vector<ColumnSpec>& specs,
+                     const std::vector<Dynamic>& vals, std::string* out);
+Status DecodeColumns(const std::vector<ColumnSpec>& specs, Slice* in,
+                     std::vector<Dynamic>* vals);
+
+}}  // namespace rocksdb::table
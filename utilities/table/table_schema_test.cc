@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <float.h>
+#include <limits>
+#include <string>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/table_schema.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+ColumnSpec Char(uint32_t width, bool descending = false) {
+  return ColumnSpec{Dynamic::T_STRING, descending, ColumnEncoding::kFixed,
+                    width, nullptr};
+}
+
+}  // namespace
+
+TEST(EncodeColumn, FixedString) {
+  for (bool descending : {false, true}) {
+    const ColumnSpec spec = Char(4, descending);
+    for (const char* s : {"", "ab", "abcd"}) {
+      std::string out = "x";
+      ASSERT_TRUE(EncodeColumn(spec, Dynamic(std::string(s)), &out).ok());
+      ASSERT_EQ(5U, out.size());
+      Slice in(out.data() + 1, 4);
+      Dynamic val;
+      ASSERT_TRUE(DecodeColumn(spec, &in, &val).ok());
+      EXPECT_EQ(s, val.getString());
+      EXPECT_TRUE(in.empty());
+    }
+  }
+}
+
+TEST(EncodeColumn, RejectsLongFixedString) {
+  for (bool descending : {false, true}) {
+    const Dynamic val(std::string("abcde"));
+    std::string out = "x";
+    EXPECT_TRUE(
+        EncodeColumn(Char(4, descending), val, &out).IsInvalidArgument());
+    EXPECT_EQ("x", out);
+  }
+}
+
+TEST(EncodeColumn, RejectsFixedStringEndingInNul) {
+  // "a\0" would encode like "a".
+  for (bool descending : {false, true}) {
+    for (const std::string& s : {std::string("a\0", 2),
+                                 std::string("\0", 1),
+                                 std::string("a\0\0\0", 4)}) {
+      std::string out;
+      EXPECT_TRUE(EncodeColumn(Char(4, descending), Dynamic(s), &out)
+                      .IsInvalidArgument());
+      EXPECT_TRUE(out.empty());
+    }
+  }
+  // A NUL inside the value is kept.
+  const std::string inner("a\0b", 3);
+  std::string out;
+  ASSERT_TRUE(EncodeColumn(Char(4), Dynamic(inner), &out).ok());
+  Slice in(out);
+  Dynamic val;
+  ASSERT_TRUE(DecodeColumn(Char(4), &in, &val).ok());
+  EXPECT_EQ(inner, val.getString());
+}
+
+TEST(EncodeColumn, FloatRange) {
+  const ColumnSpec spec = {Dynamic::T_DOUBLE, false, ColumnEncoding::kFloat,
+                           0, nullptr};
+  const double inf = std::numeric_limits<double>::infinity();
+  for (double v : {0.0, 1.5, double(FLT_MAX), -double(FLT_MAX), inf, -inf}) {
+    std::string out;
+    ASSERT_TRUE(EncodeColumn(spec, Dynamic(v), &out).ok()) << v;
+    Slice in(out);
+    Dynamic val;
+    ASSERT_TRUE(DecodeColumn(spec, &in, &val).ok());
+    EXPECT_EQ(v, val.getDouble());
+  }
+  for (double v : {1e39, -1e39, std::numeric_limits<double>::max()}) {
+    std::string out;
+    EXPECT_TRUE(EncodeColumn(spec, Dynamic(v), &out).IsInvalidArgument())
+        << v;
+    EXPECT_TRUE(out.empty());
+  }
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
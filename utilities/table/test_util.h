@@ -0,0 +1,23 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <gtest/gtest.h>
+#include <rocksdb/env.h>
+
+#include <string>
+
+namespace rocksdb { namespace table {
+
+// A path in the test directory of env, TEST_TMPDIR if it is set, named
+// after the running test so that tests don't share files.
+inline std::string PerTestPath(Env* env) {
+  std::string dir;
+  env->GetTestDirectory(&dir);
+  const ::testing::TestInfo* info =
+    ::testing::UnitTest::GetInstance()->current_test_info();
+  return dir + "/" + info->test_case_name() + "_" + info->name();
+}
+
+}}  // namespace rocksdb::table
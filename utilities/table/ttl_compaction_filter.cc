@@ -0,0 +1,50 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/ttl_compaction_filter.h"
+
+#include <time.h>
+
+namespace rocksdb { namespace table {
+
+bool TtlCompactionFilter::Filter(int /* level */, const Slice& key,
+                                 const Slice& /* value */,
+                                 std::string* /* new_value */,
+                                 bool* /* value_changed */) const {
+  int64_t id;
+  if (!schemas_->DecodeSchemaId(key, &id).ok()) {
+    return false;
+  }
+  const CompiledSchema* compiled = schemas_->Find(id);
+  if (compiled == nullptr || compiled->schema.ttl_column < 0) {
+    return false;
+  }
+  const auto& columns = compiled->schema.key;
+  const size_t ttl_column = compiled->schema.ttl_column;
+  Slice in = key;
+  for (size_t i = 0; i < ttl_column; i++) {
+    if (!SkipColumn(columns[i], &in)) {
+      return false;
+    }
+  }
+  Dynamic ts;
+  if (!compiled->key_decoders[ttl_column](columns[ttl_column], &in,
+                                           &ts).ok()) {
+    return false;
+  }
+  int64_t seconds = ts.getInt();
+  if (columns[ttl_column].encoding == ColumnEncoding::kTimestamp) {
+    seconds /= 1000000;
+  }
+  // now_ - retention can't overflow: both are positive.
+  return seconds < now_ - compiled->schema.retention;
+}
+
+std::unique_ptr<CompactionFilter>
+TtlCompactionFilterFactory::CreateCompactionFilter(
+    const CompactionFilter::Context& /* context */) {
+  return std::unique_ptr<CompactionFilter>(
+      new TtlCompactionFilter(schemas_, ::time(nullptr)));
+}
+
+}}  // namespace rocksdb::table
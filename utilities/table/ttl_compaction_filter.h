@@ -0,0 +1,59 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+
+#include "rocksdb/compaction_filter.h"
+#include "utilities/table/schema_registry.h"
+
+namespace rocksdb { namespace table {
+
+// Drops rows whose schema has a ttl_column once the time in that column,
+// in seconds or in microseconds for a timestamp column, is more than
+// retention seconds in the past. Only the schema id and the
+// ttl column of a key are decoded; values aren't looked at. Unlike
+// DBWithTTL nothing is appended to the values, so the expiry time is
+// whatever the row stores.
+class TtlCompactionFilter : public CompactionFilter {
+ public:
+  // now is the current time in seconds since the epoch, fixed for the
+  // compaction.
+  TtlCompactionFilter(std::shared_ptr<const SchemaRegistry> schemas,
+                      int64_t now)
+    : schemas_(std::move(schemas)), now_(now) {}
+
+  virtual bool Filter(int level, const Slice& key, const Slice& value,
+                      std::string* new_value,
+                      bool* value_changed) const override;
+
+  virtual const char* Name() const override {
+    return "rocksdb.table.TtlCompactionFilter";
+  }
+
+ private:
+  std::shared_ptr<const SchemaRegistry> schemas_;
+  int64_t now_;
+};
+
+// Creates a TtlCompactionFilter for each compaction. Set it as
+// Options::compaction_filter_factory.
+class TtlCompactionFilterFactory : public CompactionFilterFactory {
+ public:
+  explicit TtlCompactionFilterFactory(const SchemaRegistry& schemas)
+    : schemas_(std::make_shared<SchemaRegistry>(schemas)) {}
+
+  virtual std::unique_ptr<CompactionFilter> CreateCompactionFilter(
+      const CompactionFilter::Context& context) override;
+
+  virtual const char* Name() const override {
+    return "rocksdb.table.TtlCompactionFilterFactory";
+  }
+
+ private:
+  std::shared_ptr<const SchemaRegistry> schemas_;
+};
+
+}}  // namespace rocksdb::table
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <time.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/ttl_compaction_filter.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+const ColumnSpec kString = {Dynamic::T_STRING, false,
+                            ColumnEncoding::kDefault, 0};
+const ColumnSpec kTimestamp = {Dynamic::T_INT, false,
+                               ColumnEncoding::kTimestamp, 0};
+const ColumnSpec kDescInt = {Dynamic::T_INT, true, ColumnEncoding::kDefault,
+                             0};
+
+const int64_t kNow = 1000000;
+
+TableSchema Schema(const std::vector<ColumnSpec>& key, int ttl_column,
+                   int64_t retention) {
+  TableSchema schema;
+  schema.key = key;
+  schema.ttl_column = ttl_column;
+  schema.retention = retention;
+  return schema;
+}
+
+// A key of schema id with a string column and then time.
+std::string Key(int64_t id, int64_t time) {
+  std::string key;
+  Serialize<int64_t>(id, key);
+  Serialize<std::string>("row", key);
+  Serialize<int64_t>(time, key);
+  return key;
+}
+
+bool Filter(const CompactionFilter& filter, const std::string& key) {
+  std::string new_value;
+  bool value_changed = false;
+  bool removed = filter.Filter(1, key, "value", &new_value, &value_changed);
+  EXPECT_FALSE(value_changed);
+  return removed;
+}
+
+}  // namespace
+
+TEST(TtlCompactionFilter, DropsExpiredRows) {
+  auto schemas = std::make_shared<SchemaRegistry>();
+  ASSERT_TRUE(schemas->Add(1, Schema({kInt, kString, kInt}, 2, 100)).ok());
+  TtlCompactionFilter filter(schemas, kNow);
+
+  EXPECT_TRUE(Filter(filter, Key(1, 0)));
+  EXPECT_TRUE(Filter(filter, Key(1, kNow - 101)));
+  // Rows expire once they are more than retention seconds old.
+  EXPECT_FALSE(Filter(filter, Key(1, kNow - 100)));
+  EXPECT_FALSE(Filter(filter, Key(1, kNow)));
+  EXPECT_FALSE(Filter(filter, Key(1, kNow + 100)));
+}
+
+TEST(TtlCompactionFilter, TimestampAndDescendingColumns) {
+  auto schemas = std::make_shared<SchemaRegistry>();
+  ASSERT_TRUE(schemas->Add(1, Schema({kInt, kTimestamp}, 1, 10)).ok());
+  ASSERT_TRUE(schemas->Add(2, Schema({kInt, kDescInt}, 1, 10)).ok());
+  TtlCompactionFilter filter(schemas, kNow);
+
+  // Timestamps are in microseconds.
+  std::string old_key;
+  Serialize<int64_t>(1, old_key);
+  Serialize(Timestamp((kNow - 11) * 1000000), old_key);
+  EXPECT_TRUE(Filter(filter, old_key));
+  std::string new_key;
+  Serialize<int64_t>(1, new_key);
+  Serialize(Timestamp((kNow - 10) * 1000000), new_key);
+  EXPECT_FALSE(Filter(filter, new_key));
+
+  std::string old_desc;
+  Serialize<int64_t>(2, old_desc);
+  SerializeDescending<int64_t>(kNow - 11, old_desc);
+  EXPECT_TRUE(Filter(filter, old_desc));
+  std::string new_desc;
+  Serialize<int64_t>(2, new_desc);
+  SerializeDescending<int64_t>(kNow, new_desc);
+  EXPECT_FALSE(Filter(filter, new_desc));
+}
+
+TEST(TtlCompactionFilter, KeepsRowsItCannotDecode) {
+  auto schemas = std::make_shared<SchemaRegistry>();
+  ASSERT_TRUE(schemas->Add(1, Schema({kInt, kString, kInt}, 2, 100)).ok());
+  ASSERT_TRUE(schemas->Add(2, Schema({kInt, kString, kInt}, -1, 0)).ok());
+  TtlCompactionFilter filter(schemas, kNow);
+
+  // No ttl, an unknown schema, and keys that end before the ttl column.
+  EXPECT_FALSE(Filter(filter, Key(2, 0)));
+  EXPECT_FALSE(Filter(filter, Key(3, 0)));
+  const std::string key = Key(1, 0);
+  EXPECT_FALSE(Filter(filter, key.substr(0, key.size() - 1)));
+  EXPECT_FALSE(Filter(filter, key.substr(0, 10)));
+  EXPECT_FALSE(Filter(filter, ""));
+}
+
+TEST(TtlCompactionFilter, IndexEntriesExpireWithRows) {
+  TableSchema table = Schema({kInt, kString, kInt}, 2, 100);
+  table.value = {kInt};
+  table.indexes = {IndexSpec{5, {ColumnRef{true, 0}}}};
+  auto schemas = std::make_shared<SchemaRegistry>();
+  ASSERT_TRUE(schemas->Add(1, table).ok());
+  TtlCompactionFilter filter(schemas, kNow);
+
+  // <index id> <indexed value> <primary key>
+  std::string entry;
+  Serialize<int64_t>(5, entry);
+  Serialize<int64_t>(42, entry);
+  std::string expired = entry + Key(1, kNow - 101);
+  std::string live = entry + Key(1, kNow);
+  EXPECT_TRUE(Filter(filter, expired));
+  EXPECT_FALSE(Filter(filter, live));
+}
+
+TEST(TtlCompactionFilterFactory, UsesCurrentTime) {
+  SchemaRegistry schemas;
+  ASSERT_TRUE(schemas.Add(1, Schema({kInt, kString, kInt}, 2, 3600)).ok());
+  TtlCompactionFilterFactory factory(schemas);
+  CompactionFilter::Context context{};
+  std::unique_ptr<CompactionFilter> filter =
+      factory.CreateCompactionFilter(context);
+  ASSERT_NE(nullptr, filter);
+  const int64_t now = ::time(nullptr);
+  EXPECT_TRUE(Filter(*filter, Key(1, now - 7200)));
+  EXPECT_FALSE(Filter(*filter, Key(1, now)));
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
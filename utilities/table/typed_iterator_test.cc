@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <rocksdb/db.h>
+#include <rocksdb/env.h>
+#include <rocksdb/options.h>
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/utilities/key_builder.h"
+#include "rocksdb/utilities/typed_iterator.h"
+#include "utilities/table/test_util.h"
+
+using ::testing::InitGoogleTest;
+
+typedef TypedIterator<std::tuple<int64_t, rocksdb::Slice>,
+                      std::tuple<double>> PhotoIterator;
+
+class TypedIteratorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = rocksdb::table::PerTestPath(rocksdb::Env::Default());
+    rocksdb::DestroyDB(path_, rocksdb::Options());
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    rocksdb::DB* db;
+    ASSERT_TRUE(rocksdb::DB::Open(options, path_, &db).ok());
+    db_.reset(db);
+  }
+
+  void TearDown() override {
+    db_.reset();
+    rocksdb::DestroyDB(path_, rocksdb::Options());
+  }
+
+  void Put(int64_t album, const std::string& photo, double size) {
+    std::string key;
+    std::string value;
+    SerializeTuple(std::forward_as_tuple(album, photo), key);
+    SerializeTuple(std::make_tuple(size), value);
+    ASSERT_TRUE(db_->Put(rocksdb::WriteOptions(), key, value).ok());
+  }
+
+  std::string path_;
+  std::unique_ptr<rocksdb::DB> db_;
+};
+
+TEST_F(TypedIteratorTest, DecodesRows) {
+  Put(1, "a", 1.5);
+  Put(1, "b", 2.5);
+
+  PhotoIterator it(db_->NewIterator(rocksdb::ReadOptions()));
+  it.SeekToFirst();
+  ASSERT_TRUE(it.Valid());
+  EXPECT_EQ(1, std::get<0>(it.key()));
+  EXPECT_EQ(rocksdb::Slice("a"), std::get<1>(it.key()));
+  EXPECT_EQ(1.5, std::get<0>(it.value()));
+  it.Next();
+  ASSERT_TRUE(it.Valid());
+  EXPECT_EQ(rocksdb::Slice("b"), std::get<1>(it.key()));
+  EXPECT_EQ(2.5, std::get<0>(it.value()));
+  it.Next();
+  EXPECT_FALSE(it.Valid());
+  EXPECT_TRUE(it.status().ok());
+}
+
+TEST_F(TypedIteratorTest, StopsAtPrefix) {
+  Put(1, "a", 1.0);
+  Put(2, "a", 2.0);
+  Put(2, "b", 3.0);
+  Put(3, "a", 4.0);
+
+  PhotoIterator it(db_->NewIterator(rocksdb::ReadOptions()));
+  int rows = 0;
+  for (it.SeekPrefix(std::make_tuple(int64_t(2))); it.Valid(); it.Next()) {
+    EXPECT_EQ(2, std::get<0>(it.key()));
+    rows++;
+  }
+  EXPECT_EQ(2, rows);
+}
+
+TEST_F(TypedIteratorTest, StopsAtUpperBound) {
+  Put(1, "a", 1.0);
+  Put(2, "a", 2.0);
+  Put(3, "a", 3.0);
+
+  std::string upper_bound;
+  SerializeTuple(std::make_tuple(int64_t(3)), upper_bound);
+  PhotoIterator it(db_->NewIterator(rocksdb::ReadOptions()));
+  it.SetUpperBound(upper_bound);
+  int rows = 0;
+  for (it.Seek(std::make_tuple(int64_t(2))); it.Valid(); it.Next()) {
+    EXPECT_EQ(2, std::get<0>(it.key()));
+    rows++;
+  }
+  EXPECT_EQ(1, rows);
+}
+
+TEST_F(TypedIteratorTest, KeyBuilder) {
+  KeyBuilder row;
+  rocksdb::WriteBatch batch;
+  row.SetKeyPrefix(std::make_tuple(int64_t(7)));
+  for (int i = 0; i < 3; i++) {
+    row.Reset();
+    row.Key<rocksdb::Slice>(std::string(1, 'a' + i));
+    row.Value<double>(i);
+    row.PutTo(&batch);
+  }
+  ASSERT_TRUE(db_->Write(rocksdb::WriteOptions(), &batch).ok());
+
+  PhotoIterator it(db_->NewIterator(rocksdb::ReadOptions()));
+  int rows = 0;
+  for (it.SeekToFirst(); it.Valid(); it.Next()) {
+    EXPECT_EQ(7, std::get<0>(it.key()));
+    EXPECT_EQ(std::string(1, 'a' + rows), std::get<1>(it.key()).ToString());
+    EXPECT_EQ(rows, std::get<0>(it.value()));
+    rows++;
+  }
+  EXPECT_EQ(3, rows);
+}
+
+int main(int argc, char **argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "utilities/table/work_queue.h"
+
+using ::testing::InitGoogleTest;
+using rocksdb::table::WorkQueue;
+
+TEST(WorkQueue, FifoAndDrainAfterClose) {
+  WorkQueue<int> queue(4);
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_TRUE(queue.Push(3));
+  queue.Close();
+  EXPECT_FALSE(queue.Push(4));
+
+  int item;
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(1, item);
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(2, item);
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(3, item);
+  EXPECT_FALSE(queue.Pop(&item));
+}
+
+TEST(WorkQueue, PushBlocksWhileFull) {
+  WorkQueue<int> queue(1);
+  ASSERT_TRUE(queue.Push(1));
+  std::atomic<bool> pushed(false);
+  std::thread producer([&]() {
+    EXPECT_TRUE(queue.Push(2));
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(pushed);
+
+  int item;
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(1, item);
+  producer.join();
+  EXPECT_TRUE(pushed);
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(2, item);
+}
+
+TEST(WorkQueue, CloseWakesBlockedThreads) {
+  WorkQueue<int> empty(1);
+  std::thread consumer([&]() {
+    int item;
+    EXPECT_FALSE(empty.Pop(&item));
+  });
+  WorkQueue<int> full(1);
+  ASSERT_TRUE(full.Push(1));
+  std::thread producer([&]() { EXPECT_FALSE(full.Push(2)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  empty.Close();
+  full.Close();
+  consumer.join();
+  producer.join();
+}
+
+TEST(WorkQueue, ManyProducersAndConsumers) {
+  const int kThreads = 4;
+  const int kItems = 10000;
+  WorkQueue<int> queue(8);
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreads; t++) {
+    producers.emplace_back([&]() {
+      for (int i = 1; i <= kItems; i++) {
+        EXPECT_TRUE(queue.Push(i));
+      }
+    });
+  }
+  std::atomic<int64_t> sum(0);
+  std::atomic<int> count(0);
+  std::vector<std::thread> consumers;
+  for (int t = 0; t < kThreads; t++) {
+    consumers.emplace_back([&]() {
+      int item;
+      while (queue.Pop(&item)) {
+        sum += item;
+        count++;
+      }
+    });
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+  queue.Close();
+  for (auto& c : consumers) {
+    c.join();
+  }
+  EXPECT_EQ(kThreads * kItems, count);
+  EXPECT_EQ(int64_t(kThreads) * kItems * (kItems + 1) / 2, sum);
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
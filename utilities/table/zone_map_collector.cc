@@ -0,0 +1,161 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#include "utilities/table/zone_map_collector.h"
+
+#include "rocksdb/utilities/serialize.h"
+
+namespace rocksdb { namespace table {
+
+namespace {
+
+const std::string kRowsPrefix = "rocksdb.table.rows.";
+const std::string kDeletesPrefix = "rocksdb.table.deletes.";
+const std::string kZonePrefix = "rocksdb.table.zone.";
+const std::string kUnzoned = "rocksdb.table.unzoned";
+
+}  // namespace
+
+ZoneMapCollector::SchemaStats* ZoneMapCollector::StatsFor(int64_t id) {
+  if (last_ != nullptr && last_id_ == id) {
+    return last_;
+  }
+  auto it = stats_.find(id);
+  if (it == stats_.end()) {
+    const CompiledSchema* compiled = schemas_->Find(id);
+    if (compiled == nullptr) {
+      return nullptr;
+    }
+    SchemaStats& stats = stats_[id];
+    stats.compiled = compiled;
+    stats.zones.resize(compiled->schema.zone_map_columns.size());
+    it = stats_.find(id);
+  }
+  last_id_ = id;
+  last_ = &it->second;
+  return last_;
+}
+
+Status ZoneMapCollector::AddUserKey(const Slice& key,
+                                    const Slice& /* value */,
+                                    EntryType type,
+                                    SequenceNumber /* seq */,
+                                    uint64_t /* file_size */) {
+  int64_t id;
+  SchemaStats* stats = nullptr;
+  if (type != kEntryRangeDeletion && type != kEntryOther &&
+      schemas_->DecodeSchemaId(key, &id).ok()) {
+    stats = StatsFor(id);
+  }
+  if (stats == nullptr) {
+    // A range deletion covers keys of any column value, and keys without
+    // a schema can't be placed in a zone.
+    unzoned_++;
+    return Status::OK();
+  }
+  if (type == kEntryDelete || type == kEntrySingleDelete) {
+    stats->deletes++;
+  } else {
+    stats->rows++;
+  }
+
+  const TableSchema& schema = stats->compiled->schema;
+  Slice in = key;
+  size_t column = 0;
+  for (size_t i = 0; i < schema.zone_map_columns.size(); i++) {
+    const size_t zone_column = schema.zone_map_columns[i];
+    for (; column < zone_column; column++) {
+      if (!SkipColumn(schema.key[column], &in)) {
+        // Too short to have the column, so no range on it matches.
+        return Status::OK();
+      }
+    }
+    const char* start = in.data();
+    if (!SkipColumn(schema.key[column], &in)) {
+      return Status::OK();
+    }
+    column++;
+    Slice val(start, in.data() - start);
+    Zone& zone = stats->zones[i];
+    if (zone.empty || val.compare(zone.min) < 0) {
+      zone.min.assign(val.data(), val.size());
+    }
+    if (zone.empty || val.compare(zone.max) > 0) {
+      zone.max.assign(val.data(), val.size());
+    }
+    zone.empty = false;
+  }
+  return Status::OK();
+}
+
+Status ZoneMapCollector::Finish(UserCollectedProperties* properties) {
+  for (const auto& entry : stats_) {
+    const std::string id = std::to_string(entry.first);
+    const SchemaStats& stats = entry.second;
+    (*properties)[kRowsPrefix + id] = std::to_string(stats.rows);
+    (*properties)[kDeletesPrefix + id] = std::to_string(stats.deletes);
+    const auto& columns = stats.compiled->schema.zone_map_columns;
+    for (size_t i = 0; i < columns.size(); i++) {
+      const Zone& zone = stats.zones[i];
+      if (zone.empty) {
+        continue;
+      }
+      std::string encoded;
+      Serialize(zone.min, encoded);
+      Serialize(zone.max, encoded);
+      (*properties)[kZonePrefix + id + "." + std::to_string(columns[i])] =
+          std::move(encoded);
+    }
+  }
+  (*properties)[kUnzoned] = std::to_string(unzoned_);
+  return Status::OK();
+}
+
+UserCollectedProperties ZoneMapCollector::GetReadableProperties() const {
+  UserCollectedProperties readable;
+  for (const auto& entry : stats_) {
+    const std::string id = std::to_string(entry.first);
+    readable[kRowsPrefix + id] = std::to_string(entry.second.rows);
+    readable[kDeletesPrefix + id] = std::to_string(entry.second.deletes);
+  }
+  readable[kUnzoned] = std::to_string(unzoned_);
+  return readable;
+}
+
+TablePropertiesCollector*
+ZoneMapCollectorFactory::CreateTablePropertiesCollector(
+    TablePropertiesCollectorFactory::Context /* context */) {
+  return new ZoneMapCollector(schemas_);
+}
+
+bool ZoneMapMayMatch(const TableProperties& properties,
+                     const KeyColumnRange& range) {
+  const auto& user = properties.user_collected_properties;
+  auto unzoned = user.find(kUnzoned);
+  if (unzoned == user.end() || unzoned->second != "0") {
+    // Written without zone maps, or has entries outside of them.
+    return true;
+  }
+  const std::string column = "." + std::to_string(range.leading().size());
+  for (auto it = user.lower_bound(kRowsPrefix);
+       it != user.end() && Slice(it->first).starts_with(kRowsPrefix);
+       ++it) {
+    const std::string id = it->first.substr(kRowsPrefix.size());
+    auto zone = user.find(kZonePrefix + id + column);
+    if (zone == user.end()) {
+      // The column isn't zone mapped in this schema.
+      return true;
+    }
+    Slice in(zone->second);
+    std::string min = Deserialize<std::string>(in);
+    std::string max = Deserialize<std::string>(in);
+    if ((range.lower().empty() || max >= range.lower()) &&
+        (range.upper_successor().empty() ||
+         min < range.upper_successor())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}}  // namespace rocksdb::table
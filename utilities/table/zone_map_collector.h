@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Facebook. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/table_properties.h"
+#include "utilities/table/key_column_range.h"
+#include "utilities/table/schema_registry.h"
+
+namespace rocksdb { namespace table {
+
+// Records zone maps in the user collected properties of each SST file:
+// for every schema id in the file, its entry counts and the min and max
+// of its zone_map_columns. The min and max are encoded column values,
+// compared bytewise like keys, so they are found without decoding.
+//
+// The properties are, per schema id:
+//
+//   rocksdb.table.rows.<id>           puts, in decimal
+//   rocksdb.table.deletes.<id>        deletions, in decimal
+//   rocksdb.table.zone.<id>.<column>  min then max, serialized strings
+//
+// and rocksdb.table.unzoned, the entries with no schema or range
+// deletions, which make the file unsafe to skip.
+class ZoneMapCollector : public TablePropertiesCollector {
+ public:
+  explicit ZoneMapCollector(std::shared_ptr<const SchemaRegistry> schemas)
+    : schemas_(std::move(schemas)),
+      last_id_(0),
+      last_(nullptr),
+      unzoned_(0) {}
+
+  virtual Status AddUserKey(const Slice& key, const Slice& value,
+                            EntryType type, SequenceNumber seq,
+                            uint64_t file_size) override;
+
+  virtual Status Finish(UserCollectedProperties* properties) override;
+
+  // The entry counts.
+  virtual UserCollectedProperties GetReadableProperties() const override;
+
+  virtual const char* Name() const override {
+    return "rocksdb.table.ZoneMapCollector";
+  }
+
+ private:
+  struct Zone {
+    std::string min;
+    std::string max;
+    bool empty = true;
+  };
+  struct SchemaStats {
+    const CompiledSchema* compiled = nullptr;
+    uint64_t rows = 0;
+    uint64_t deletes = 0;
+    // One per zone_map_columns entry.
+    std::vector<Zone> zones;
+  };
+
+  SchemaStats* StatsFor(int64_t id);
+
+  std::shared_ptr<const SchemaRegistry> schemas_;
+  std::map<int64_t, SchemaStats> stats_;
+  // Keys come sorted, so runs of keys have the same schema id.
+  int64_t last_id_;
+  SchemaStats* last_;
+  uint64_t unzoned_;
+};
+
+// Creates a ZoneMapCollector per SST file. Add it to
+// Options::table_properties_collector_factories.
+class ZoneMapCollectorFactory : public TablePropertiesCollectorFactory {
+ public:
+  explicit ZoneMapCollectorFactory(const SchemaRegistry& schemas)
+    : schemas_(std::make_shared<SchemaRegistry>(schemas)) {}
+
+  virtual TablePropertiesCollector* CreateTablePropertiesCollector(
+      TablePropertiesCollectorFactory::Context context) override;
+
+  virtual const char* Name() const override {
+    return "rocksdb.table.ZoneMapCollectorFactory";
+  }
+
+ private:
+  std::shared_ptr<const SchemaRegistry> schemas_;
+};
+
+// False if the zone maps of a file show that none of its keys has the
+// column of range in range, so a scan can skip it. Use it as
+// ReadOptions::table_filter. Files without zone maps for the column, or
+// with unzoned entries, are kept.
+bool ZoneMapMayMatch(const TableProperties& properties,
+                     const KeyColumnRange& range);
+
+}}  // namespace rocksdb::table
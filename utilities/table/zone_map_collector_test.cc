@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/utilities/serialize.h"
+#include "utilities/table/zone_map_collector.h"
+
+using ::testing::InitGoogleTest;
+using namespace rocksdb;
+using namespace rocksdb::table;
+
+namespace {
+
+const ColumnSpec kInt = {Dynamic::T_INT, false, ColumnEncoding::kDefault, 0};
+const ColumnSpec kString = {Dynamic::T_STRING, false,
+                            ColumnEncoding::kDefault, 0};
+
+std::string Int(int64_t v) {
+  std::string encoded;
+  Serialize<int64_t>(v, encoded);
+  return encoded;
+}
+
+// A key of schema id with columns name and n, zone mapped on n.
+std::string Key(int64_t id, const std::string& name, int64_t n) {
+  std::string key = Int(id);
+  Serialize<std::string>(name, key);
+  Serialize<int64_t>(n, key);
+  return key;
+}
+
+// The range n in [lower, upper] on the column after the schema id and
+// name.
+KeyColumnRange Range(int64_t lower, int64_t upper) {
+  return KeyColumnRange({kInt, kString}, Int(lower), Int(upper));
+}
+
+class ZoneMapCollectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override { Reset(); }
+
+  // Start a new file.
+  void Reset() {
+    TableSchema zoned;
+    zoned.key = {kInt, kString, kInt};
+    zoned.zone_map_columns = {2};
+    TableSchema unzoned;
+    unzoned.key = {kInt, kString, kInt};
+    auto schemas = std::make_shared<SchemaRegistry>();
+    ASSERT_TRUE(schemas->Add(1, zoned).ok());
+    ASSERT_TRUE(schemas->Add(2, zoned).ok());
+    ASSERT_TRUE(schemas->Add(3, unzoned).ok());
+    collector_.reset(new ZoneMapCollector(schemas));
+  }
+
+  void Add(const std::string& key, EntryType type = kEntryPut) {
+    ASSERT_TRUE(collector_->AddUserKey(key, "", type, 0, 0).ok());
+  }
+
+  TableProperties Finish() {
+    TableProperties properties;
+    EXPECT_TRUE(
+        collector_->Finish(&properties.user_collected_properties).ok());
+    return properties;
+  }
+
+  std::unique_ptr<ZoneMapCollector> collector_;
+};
+
+}  // namespace
+
+TEST_F(ZoneMapCollectorTest, SkipsFilesOutsideRange) {
+  Add(Key(1, "a", 30));
+  Add(Key(1, "b", 10));
+  Add(Key(1, "c", 20));
+  Add(Key(1, "d", 15), kEntryDelete);
+  TableProperties properties = Finish();
+
+  const auto& user = properties.user_collected_properties;
+  EXPECT_EQ("3", user.at("rocksdb.table.rows.1"));
+  EXPECT_EQ("1", user.at("rocksdb.table.deletes.1"));
+  EXPECT_EQ("0", user.at("rocksdb.table.unzoned"));
+
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(0, 10)));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(30, 40)));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(16, 17)));
+  EXPECT_FALSE(ZoneMapMayMatch(properties, Range(0, 9)));
+  EXPECT_FALSE(ZoneMapMayMatch(properties, Range(31, 40)));
+
+  KeyColumnRange at_least({kInt, kString}, Int(31), "");
+  EXPECT_FALSE(ZoneMapMayMatch(properties, at_least));
+  KeyColumnRange at_most({kInt, kString}, "", Int(10));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, at_most));
+}
+
+TEST_F(ZoneMapCollectorTest, AnySchemaMayMatch) {
+  Add(Key(1, "a", 10));
+  Add(Key(2, "a", 50));
+  TableProperties properties = Finish();
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(5, 10)));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(50, 60)));
+  EXPECT_FALSE(ZoneMapMayMatch(properties, Range(20, 40)));
+}
+
+TEST_F(ZoneMapCollectorTest, KeepsFilesWithoutZones) {
+  // A schema that doesn't zone map the column.
+  Add(Key(1, "a", 10));
+  Add(Key(3, "a", 10));
+  EXPECT_TRUE(ZoneMapMayMatch(Finish(), Range(50, 60)));
+
+  // Nothing was collected.
+  EXPECT_TRUE(ZoneMapMayMatch(TableProperties(), Range(50, 60)));
+
+  // The range is on a column with no zone map.
+  Reset();
+  Add(Key(1, "a", 10));
+  KeyColumnRange name({kInt}, Int(0), Int(1));
+  EXPECT_TRUE(ZoneMapMayMatch(Finish(), name));
+}
+
+TEST_F(ZoneMapCollectorTest, UnzonedEntriesKeepFile) {
+  Add(Key(1, "a", 10));
+  Add(Key(1, "b", 20), kEntryRangeDeletion);
+  TableProperties properties = Finish();
+  EXPECT_EQ("1", properties.user_collected_properties.at(
+                     "rocksdb.table.unzoned"));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(50, 60)));
+
+  // Keys of an unknown schema.
+  Reset();
+  Add(Key(1, "a", 10));
+  Add(Key(9, "a", 10));
+  EXPECT_TRUE(ZoneMapMayMatch(Finish(), Range(50, 60)));
+}
+
+TEST_F(ZoneMapCollectorTest, ShortKeysAreNotZoned) {
+  Add(Key(1, "a", 10));
+  std::string short_key = Int(1);
+  Serialize<std::string>("b", short_key);
+  Add(short_key);
+  TableProperties properties = Finish();
+  EXPECT_EQ("2", properties.user_collected_properties.at(
+                     "rocksdb.table.rows.1"));
+  EXPECT_FALSE(ZoneMapMayMatch(properties, Range(50, 60)));
+  EXPECT_TRUE(ZoneMapMayMatch(properties, Range(10, 10)));
+}
+
+TEST_F(ZoneMapCollectorTest, ReadableProperties) {
+  Add(Key(1, "a", 10));
+  Add(Key(2, "a", 10), kEntrySingleDelete);
+  UserCollectedProperties readable = collector_->GetReadableProperties();
+  EXPECT_EQ("1", readable.at("rocksdb.table.rows.1"));
+  EXPECT_EQ("0", readable.at("rocksdb.table.deletes.1"));
+  EXPECT_EQ("0", readable.at("rocksdb.table.rows.2"));
+  EXPECT_EQ("1", readable.at("rocksdb.table.deletes.2"));
+  EXPECT_EQ(0U, readable.count("rocksdb.table.zone.1.2"));
+}
+
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}